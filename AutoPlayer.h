@@ -0,0 +1,126 @@
+#pragma once
+#ifndef AUTO_PLAYER_H
+#define AUTO_PLAYER_H
+
+#include "Directions.h"
+#include "GameState.h"
+#include "Bot.h"
+#include "InputRecorder.h"
+#include "Job.h"
+
+// time without touching the joystick on the welcome
+// screen before the autoplayer starts, in ms
+const unsigned long autoPlayerIdleTimeout = 30000;
+// minimum game time between two movements, in ms
+const unsigned int autoPlayerMoveInterval = 500;
+// cells of the distance field filled in by one unit of the
+// planning job, which goes on until its budget is spent
+const unsigned int autoPlayerCellsPerUnit = 8;
+// time the planning can take during one frame, in µs
+const unsigned int autoPlayerPlanningBudget = 1000;
+// chance, in percents, of a random movement, so the
+// attract mode looks like somebody is playing
+const byte autoPlayerMistakeChance = 5;
+
+/*
+  Plays the game on the board when nobody does: the bot plans
+  its route on a distance field, filled in a few cells at a time,
+  and its directions go through step() like the joystick's.
+
+  It also keeps count of the games played and of how long
+  the planning took, so it can be left running as a soak test.
+*/
+struct AutoPlayer{
+  Bot bot;
+  // fills the field of the current goal, a slice per frame
+  Job job;
+
+  // game time after which the next movement can be made, in ms
+  unsigned long nextMoveTime;
+
+  // soak statistics, since the autoplayer was started
+  unsigned int gamesPlayed;
+  unsigned int gamesWon;
+  unsigned int deaths;
+
+  AutoPlayer(): job("planning", autoPlayerPlanningBudget), nextMoveTime(0),
+                gamesPlayed(0), gamesWon(0), deaths(0) {}
+
+  void start(uint32_t seed);
+  void newGame();
+  byte advance();
+  GameInput update(const GameState &state);
+  void gameEnded(const GameState &state);
+  void printStatistics();
+};
+
+/*
+  Start a new soak run, forgetting the previous statistics.
+*/
+void AutoPlayer::start(uint32_t seed){
+  bot.reset(seed, autoPlayerMistakeChance);
+
+  gamesPlayed = 0;
+  gamesWon = 0;
+  deaths = 0;
+
+  newGame();
+}
+
+void AutoPlayer::newGame(){
+  nextMoveTime = 0;
+
+  // the field of the last game does not match the new one
+  bot.goalRoom = roomsSize;
+}
+
+/*
+  One unit of the planning job: a few more cells of the field.
+*/
+byte AutoPlayer::advance(){
+  return bot.field.advance(autoPlayerCellsPerUnit) ? jobDone : jobWorking;
+}
+
+/*
+  Input for the next step of the game. Every goal starts the
+  planning job again, which runs a slice per frame; if the field
+  is not ready when a move is due, the player waits until it is.
+*/
+GameInput AutoPlayer::update(const GameState &state){
+  // the events are still the ones of the last step
+  if (state.events & eventPlayerDied) {
+    deaths += 1;
+  }
+
+  if (bot.setGoal(state)) {
+    job.start();
+  }
+  runSlice(*this);
+
+  if (job.isRunning || state.now < nextMoveTime || state.isInPause) {
+    return GameInput(joystickNone, false);
+  }
+
+  nextMoveTime = state.now + autoPlayerMoveInterval;
+  return GameInput(bot.pickDirection(state), false);
+}
+
+void AutoPlayer::gameEnded(const GameState &state){
+  gamesPlayed += 1;
+  if (state.player.isWinning) {
+    gamesWon += 1;
+  }
+
+  printStatistics();
+}
+
+/*
+  Log the soak statistics, once per game.
+*/
+void AutoPlayer::printStatistics(){
+  LOG_INFO(logAutoPlayStatistics, gamesPlayed, gamesWon, deaths);
+
+  job.printStatistics();
+}
+
+#endif
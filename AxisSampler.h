@@ -0,0 +1,107 @@
+#pragma once
+#ifndef AXIS_SAMPLER_H
+#define AXIS_SAMPLER_H
+
+/*
+  Reads the joystick's axes in the background: the ADC runs in
+  free running mode and its interrupt alternates between the
+  X and Y channels, averaging every 16 samples of an axis.
+  Reading the axes then costs a copy of two values, instead
+  of two blocking analogRead() calls of ~110 µs each.
+
+  With the ADC clock at 16 MHz / 128, a conversion takes
+  104 µs, so each axis gets a new average every ~3.3 ms.
+  On the model of tools/AxisModel.cpp, the average has about a
+  quarter of the noise of a sample, and a push of the stick is
+  half way in the value after 3.3 ms on average, 5.1 ms at most.
+
+  Anything else calling analogRead() would change the channel
+  under the interrupt, so it needs to happen before the
+  sampler starts (like seeding random() in setup()).
+*/
+
+// samples averaged in one value of an axis
+const byte axisSamplesAveraged = 16;
+const byte axisSamplesShift = 4;
+
+#ifdef __AVR__
+
+// ADC channel of each axis
+byte axisChannels[2];
+// latest averaged value of each axis, 0 - 1023
+volatile int axisValues[2] = {512, 512};
+
+// the axis of the conversion that just ended, and of the
+// one the ADC already started when its interrupt was raised
+byte convertingAxis;
+byte pendingAxis;
+
+uint16_t axisSums[2];
+byte axisSamples[2];
+
+ISR(ADC_vect){
+  int sample = ADC;
+  byte axis = convertingAxis;
+
+  // the next conversion already started on the pending axis,
+  // so the channel chosen now is used by the one after it
+  convertingAxis = pendingAxis;
+  pendingAxis = 1 - pendingAxis;
+  ADMUX = (1 << REFS0) | axisChannels[pendingAxis];
+
+  axisSums[axis] += sample;
+  axisSamples[axis] += 1;
+
+  if (axisSamples[axis] == axisSamplesAveraged) {
+    axisValues[axis] = axisSums[axis] >> axisSamplesShift;
+    axisSums[axis] = 0;
+    axisSamples[axis] = 0;
+  }
+}
+
+void startAxisSampler(byte pinX, byte pinY){
+  axisChannels[0] = pinX - A0;
+  axisChannels[1] = pinY - A0;
+
+  // the digital input buffers only add noise on analog pins
+  DIDR0 |= (1 << axisChannels[0]) | (1 << axisChannels[1]);
+
+  convertingAxis = 0;
+  pendingAxis = 0;
+  ADMUX = (1 << REFS0) | axisChannels[0];
+
+  // free running mode, interrupt after every conversion
+  ADCSRB = 0;
+  ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  ADCSRA |= (1 << ADSC);
+}
+
+/*
+  Copy the latest averaged values, with the interrupt
+  off so an axis is not read while it is being written.
+*/
+void readAxes(int &x, int &y){
+  noInterrupts();
+  x = axisValues[0];
+  y = axisValues[1];
+  interrupts();
+}
+
+#else
+
+// without the AVR's ADC, read the axes directly
+byte axisPins[2];
+
+void startAxisSampler(byte pinX, byte pinY){
+  axisPins[0] = pinX;
+  axisPins[1] = pinY;
+}
+
+void readAxes(int &x, int &y){
+  x = analogRead(axisPins[0]);
+  y = analogRead(axisPins[1]);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,158 @@
+#pragma once
+#ifndef BOT_H
+#define BOT_H
+
+#include "Platform.h"
+#include "Directions.h"
+#include "GameRandom.h"
+#include "GameState.h"
+#include "DistanceField.h"
+
+// what the bot is currently walking towards
+const byte botGoalNote = 0;
+const byte botGoalDoctor = 1;
+const byte botGoalExit = 2;
+// squared distance to Dr. Nocturne the bot will not step into
+const byte botDangerDistance = 1;
+// extra distance given to the moves that are too close to the Dr.
+const byte botDangerPenalty = 100;
+
+/*
+  Scripted player that looks at the game state and decides
+  where to point the joystick:
+  -> collect the note while Dr. Nocturne is inactive
+  -> walk towards the waiting Dr. to make him start chasing
+  -> run out of the room while he is chasing
+
+  Every goal is a distance field, so the route always follows
+  the shortest path through the rooms and their doors.
+*/
+struct Bot{
+  DistanceField field;
+  GameRandom random;
+
+  // the goal the current field was computed for
+  byte goal;
+  byte goalRoom;
+  byte goalRow;
+  byte goalColumn;
+
+  // chance, in percents, of pointing in a random direction
+  byte mistakeChance;
+
+  Bot(): goal(botGoalNote), goalRoom(roomsSize), goalRow(0), goalColumn(0), mistakeChance(0) {}
+
+  void reset(uint32_t seed, byte mistakeChance);
+  bool setGoal(const GameState &state);
+  byte chooseDirection(const GameState &state);
+  byte pickDirection(const GameState &state);
+  unsigned int scoreMove(const GameState &state, const Player &next);
+};
+
+void Bot::reset(uint32_t seed, byte mistakeChance){
+  random.seed(seed);
+  this->mistakeChance = mistakeChance;
+
+  // force the field to be computed for the first goal
+  goalRoom = roomsSize;
+}
+
+/*
+  Pick the goal for the current state. Returns true if it
+  differs from the goal the field was computed for.
+*/
+bool Bot::setGoal(const GameState &state){
+  byte newGoal = botGoalNote;
+  byte newRoom = state.note.currentRoom;
+  byte newRow = state.note.row;
+  byte newColumn = state.note.column;
+
+  if (state.doctor.isChasing) {
+    newGoal = botGoalExit;
+    newRoom = state.player.currentRoom;
+    newRow = 0;
+    newColumn = 0;
+  } else if (state.doctor.isWaiting) {
+    newGoal = botGoalDoctor;
+    newRoom = state.doctor.currentRoom;
+    newRow = state.doctor.row;
+    newColumn = state.doctor.column;
+  }
+
+  if (newGoal == goal && newRoom == goalRoom && newRow == goalRow && newColumn == goalColumn) {
+    return false;
+  }
+
+  goal = newGoal;
+  goalRoom = newRoom;
+  goalRow = newRow;
+  goalColumn = newColumn;
+
+  field.clear();
+  if (goal == botGoalExit) {
+    field.addRoomSources(goalRoom);
+  } else {
+    field.addSource(goalRoom, goalRow, goalColumn);
+  }
+
+  return true;
+}
+
+/*
+  Cost of ending up in the given position: its distance to
+  the goal, plus a penalty if it walks into Dr. Nocturne.
+*/
+unsigned int Bot::scoreMove(const GameState &state, const Player &next){
+  unsigned int score = field.distance(next.currentRoom, next.row, next.column);
+  bool doctorIsActive = state.doctor.isChasing || state.doctor.isWaiting;
+
+  if (doctorIsActive && next.currentRoom == state.doctor.currentRoom
+      && squaredDistance(next.row, next.column, state.doctor.row, state.doctor.column) <= botDangerDistance) {
+    // walking to the waiting Dr. is the goal, stepping on him is not
+    if (goal != botGoalDoctor || (next.row == state.doctor.row && next.column == state.doctor.column)) {
+      score += botDangerPenalty;
+    }
+  }
+
+  return score;
+}
+
+/*
+  Decide in which direction the joystick should point for
+  the current state, or joystickNone to stay in place.
+*/
+byte Bot::chooseDirection(const GameState &state){
+  setGoal(state);
+  field.compute();
+
+  return pickDirection(state);
+}
+
+/*
+  Pick the best direction from the field, which
+  needs to be complete for the current goal.
+*/
+byte Bot::pickDirection(const GameState &state){
+  if (mistakeChance > 0 && random.below(100) < mistakeChance) {
+    return random.below(directions);
+  }
+
+  // staying in place is also a move
+  byte bestDirection = joystickNone;
+  unsigned int bestScore = scoreMove(state, state.player);
+
+  for (byte direction = 0; direction < directions; direction++) {
+    Player next = state.player;
+    next.movementWatcher(direction);
+
+    unsigned int score = scoreMove(state, next);
+    if (score < bestScore) {
+      bestScore = score;
+      bestDirection = direction;
+    }
+  }
+
+  return bestDirection;
+}
+
+#endif
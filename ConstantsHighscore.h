@@ -3,8 +3,18 @@
 #define CONSTANTS_PLAYER_NAME_SIZE_h
 
 // maximum number of highscores that will be registered
-const byte maximumHighscores = 3;
+const byte maximumHighscores = 50;
 // maximum size of the player name
 const byte playerNameSize = 3;
+// score of the empty places, 15:00 minutes in centiseconds
+const unsigned long highscoreDefaultValue = 90000;
 
-#endif
\ No newline at end of file
+// address in EEPROM memory where the table of highscores starts;
+// a highscore takes 4 bytes, see Highscores.h
+const int highscoresStartAddr = 64;
+const byte highscoreSize = 4;
+// one slot more than the highscores, the free one
+// a new highscore is written to
+const byte highscoreSlots = maximumHighscores + 1;
+
+#endif
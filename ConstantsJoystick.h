@@ -0,0 +1,14 @@
+#pragma once
+#ifndef CONSTANTS_JOYSTICK_H
+#define CONSTANTS_JOYSTICK_H
+
+// a held direction repeats after the delay, then every interval;
+// each repeat is faster than the one before, down to the fastest
+// interval. The intervals are for the stick pushed all the way,
+// they get up to twice as long when it is pushed less.
+const int joystickRepeatDelay = 300;
+const int joystickRepeatInterval = 250;
+const int joystickRepeatAcceleration = 15;
+const int joystickRepeatFastestInterval = 150;
+
+#endif
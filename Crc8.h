@@ -0,0 +1,29 @@
+#pragma once
+#ifndef CRC8_H
+#define CRC8_H
+
+#include "Platform.h"
+
+/*
+  CRC-8 of the given bytes (Dallas / Maxim polynomial),
+  computed bit by bit, so it needs no table in flash.
+*/
+byte crc8(const byte data[], byte size){
+  byte crc = 0;
+
+  for (byte i = 0; i < size; i++) {
+    crc ^= data[i];
+
+    for (byte bit = 0; bit < 8; bit++) {
+      if (crc & 1) {
+        crc = (crc >> 1) ^ 0x8C;
+      } else {
+        crc >>= 1;
+      }
+    }
+  }
+
+  return crc;
+}
+
+#endif
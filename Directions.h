@@ -0,0 +1,16 @@
+#pragma once
+#ifndef DIRECTIONS_H
+#define DIRECTIONS_H
+
+#include "Platform.h"
+
+/* each direction of the joystick will have a
+column in the matrix associated*/
+const byte joystickUp = 0;
+const byte joystickDown = 1;
+const byte joystickLeft = 2;
+const byte joystickRight = 3;
+// the joystick is not pointing anywhere
+const byte joystickNone = 255;
+
+#endif
@@ -0,0 +1,223 @@
+#pragma once
+#ifndef DISTANCE_FIELD_H
+#define DISTANCE_FIELD_H
+
+#include "Platform.h"
+#include "Directions.h"
+#include "Rooms.h"
+#include "Player.h"
+
+// every cell of every room, indexed as room * 64 + row * 8 + column
+const unsigned int worldCells = roomsSize * matrixSize * matrixSize;
+// distance of the cells that cannot reach any source
+const byte unreachableDistance = 255;
+
+unsigned int cellIndex(byte room, byte row, byte column){
+  return (room * matrixSize + row) * matrixSize + column;
+}
+
+/*
+  Number of moves from every cell of the house to the closest
+  source cell, moving like the player does (doors included).
+
+  The doors connect the rooms both ways, so the moves needed
+  to reach a source are also the moves needed to come back from it.
+
+  The field is filled layer by layer: two bitmaps hold the cells
+  at the current distance and the cells found for the next one.
+  It needs no queue, only touches the cells of the frontier and
+  it can be stopped and resumed between any two of them.
+*/
+struct DistanceField{
+  byte distances[worldCells];
+  byte frontier[worldCells / 8];
+  byte nextFrontier[worldCells / 8];
+
+  // distance of the layer being expanded
+  byte layer;
+  // next cell to scan in the current layer
+  unsigned int scanIndex;
+  bool isComplete;
+
+  DistanceField(): layer(0), scanIndex(0), isComplete(true) {}
+
+  // functions to fill the field
+  void clear();
+  void addSource(byte room, byte row, byte column);
+  void addRoomSources(byte skippedRoom);
+  bool advance(unsigned int cellsBudget);
+  void compute();
+
+  byte distance(byte room, byte row, byte column) const;
+};
+
+/*
+  Mark every cell as unreachable and start a new field.
+*/
+void DistanceField::clear(){
+  for (unsigned int cell = 0; cell < worldCells; cell++) {
+    distances[cell] = unreachableDistance;
+  }
+
+  for (byte block = 0; block < worldCells / 8; block++) {
+    frontier[block] = 0;
+    nextFrontier[block] = 0;
+  }
+
+  layer = 0;
+  scanIndex = 0;
+  isComplete = false;
+}
+
+void DistanceField::addSource(byte room, byte row, byte column){
+  unsigned int cell = cellIndex(room, row, column);
+
+  distances[cell] = 0;
+  frontier[cell / 8] |= 1 << (cell % 8);
+}
+
+/*
+  Make every open cell outside the skipped room a source,
+  so the field tells how far the closest way out of that room is.
+*/
+void DistanceField::addRoomSources(byte skippedRoom){
+  for (byte room = 0; room < roomsSize; room++) {
+    if (room == skippedRoom) {
+      continue;
+    }
+
+    for (byte row = 0; row < matrixSize; row++) {
+      for (byte column = 0; column < matrixSize; column++) {
+        if (rooms[room][row][column] == false) {
+          addSource(room, row, column);
+        }
+      }
+    }
+  }
+}
+
+/*
+  Expand at most cellsBudget cells of the frontier, giving
+  their unvisited neighbours the next distance.
+  Returns true once the whole field is filled.
+*/
+bool DistanceField::advance(unsigned int cellsBudget){
+  while (!isComplete && cellsBudget > 0) {
+    // the layer was scanned, continue with the cells found
+    // for the next one, unless there is nothing left to reach
+    if (scanIndex == worldCells) {
+      bool hasCells = false;
+
+      for (byte block = 0; block < worldCells / 8; block++) {
+        frontier[block] = nextFrontier[block];
+        nextFrontier[block] = 0;
+        hasCells = hasCells || frontier[block] != 0;
+      }
+
+      layer += 1;
+      scanIndex = 0;
+      isComplete = !hasCells || layer == unreachableDistance;
+      continue;
+    }
+
+    // skip 8 cells at once when none of them is in the frontier
+    if (frontier[scanIndex / 8] == 0) {
+      scanIndex += 8;
+      continue;
+    }
+
+    if (frontier[scanIndex / 8] & (1 << (scanIndex % 8))) {
+      cellsBudget -= 1;
+
+      // move a player from this cell in every direction
+      // and reach the neighbours through walls and doors
+      for (byte direction = 0; direction < directions; direction++) {
+        Player walker;
+        walker.currentRoom = scanIndex / (matrixSize * matrixSize);
+        walker.row = (scanIndex / matrixSize) % matrixSize;
+        walker.column = scanIndex % matrixSize;
+        walker.movementWatcher(direction);
+
+        unsigned int neighbour = cellIndex(walker.currentRoom, walker.row, walker.column);
+        if (distances[neighbour] == unreachableDistance) {
+          distances[neighbour] = layer + 1;
+          nextFrontier[neighbour / 8] |= 1 << (neighbour % 8);
+        }
+      }
+    }
+
+    scanIndex += 1;
+  }
+
+  return isComplete;
+}
+
+/*
+  Fill the whole field at once.
+*/
+void DistanceField::compute(){
+  while (!advance(worldCells)) {}
+}
+
+byte DistanceField::distance(byte room, byte row, byte column) const{
+  return distances[cellIndex(room, row, column)];
+}
+
+/*
+  Number of moves between two cells of the same room, without
+  leaving it, or unreachableDistance. Every row of the room is a
+  byte with a bit per column, so a whole layer of the search is
+  found with a few shifts per row, with no field to fill.
+*/
+byte roomDistance(byte room, byte fromRow, byte fromColumn, byte toRow, byte toColumn){
+  byte open[matrixSize];
+  byte reached[matrixSize];
+
+  for (byte row = 0; row < matrixSize; row++) {
+    open[row] = 0;
+    reached[row] = 0;
+
+    for (byte column = 0; column < matrixSize; column++) {
+      if (!rooms[room][row][column]) {
+        open[row] |= 1 << column;
+      }
+    }
+  }
+
+  reached[fromRow] = 1 << fromColumn;
+
+  for (byte distance = 0; distance < matrixSize * matrixSize; distance++) {
+    if (reached[toRow] & (1 << toColumn)) {
+      return distance;
+    }
+
+    // every reached cell also reaches its four neighbours
+    byte next[matrixSize];
+    bool hasGrown = false;
+
+    for (byte row = 0; row < matrixSize; row++) {
+      byte cells = reached[row] | (reached[row] << 1) | (reached[row] >> 1);
+      if (row > 0) {
+        cells |= reached[row - 1];
+      }
+      if (row < matrixSize - 1) {
+        cells |= reached[row + 1];
+      }
+
+      next[row] = cells & open[row];
+      hasGrown = hasGrown || next[row] != reached[row];
+    }
+
+    if (!hasGrown) {
+      break;
+    }
+
+    for (byte row = 0; row < matrixSize; row++) {
+      reached[row] = next[row];
+    }
+  }
+
+  return unreachableDistance;
+}
+
+#endif
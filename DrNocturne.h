@@ -2,17 +2,43 @@
 #ifndef DR_NOCTURNE_H
 #define DR_NOCTURNE_H
 
-#include <LiquidCrystal.h>
-
+#include "Platform.h"
+#include "GameRandom.h"
 #include "Rooms.h"
 #include "Player.h"
-#include "Utils.h"
-#include "ConstantsBlinking.h"
+#include "TunedConstants.h"
+
+/*
+  How fast Dr. Nocturne moves and how close the player needs
+  to come before he starts chasing, on levels 2 and 3.
+  The board uses the tuned constants, the host tools swap
+  in other values to search for better ones.
+*/
+struct DoctorTuning{
+  int movementCooldown;
+  int movementCooldownLastLevel;
+  byte chaseDistance;
+  byte chaseDistanceLastLevel;
+};
 
-// interval time between movements on level 1
-const int movementCooldown = 1000;
-// interval time between movements on level 2
-const int movementCooldownLastLevel = 850;
+const DoctorTuning defaultDoctorTuning = {
+  movementCooldown, movementCooldownLastLevel, chaseDistance, chaseDistanceLastLevel
+};
+
+// value for the moves that cannot be made, bigger than any distance
+const int impossibleMoveDistance = 1000;
+
+/*
+  Calculate the squared euclidean distance between two cells.
+  Comparing squared distances orders the moves exactly like the
+  euclidean distance does, without any floating point math.
+*/
+int squaredDistance(byte firstRow, byte firstColumn, byte secondRow, byte secondColumn) {
+  int rowDifference = firstRow - secondRow;
+  int columnDifference = firstColumn - secondColumn;
+
+  return rowDifference * rowDifference + columnDifference * columnDifference;
+}
 
 struct DrNocturne{
   byte row;
@@ -20,80 +46,76 @@ struct DrNocturne{
   byte currentRoom;
   byte level;
 
-  // controls the Dr's visibility
-  bool isDisplay;
   // controls if Dr. Nocturne needs to wait 
   // for the player to get closer
   bool isWaiting;
   // controls if Dr. Nocturne is chasing the player
   bool isChasing;
 
-  // last time when isDisplayed changes its states, in ms
-  unsigned long lastDisplayBlinking;
+  // game time of the last movement, in ms
   unsigned long lastMovement;
 
-  DrNocturne(){
-    reset();
-  }
+  const DoctorTuning *tuning;
 
-  // functions to spawn the note
-  void spawnDoctorRandomly();
-  void spawnDoctorSameRoom(Player player);
-  void spawnInRoom();
-  void spawnInSameRoom(Player player);
+  DrNocturne(): row(0), column(0), currentRoom(0), level(1), 
+                isWaiting(false), isChasing(false), lastMovement(0),
+                tuning(&defaultDoctorTuning) {}
 
-  void isWaitingToChase(Player player);
-  void chase(LedControl &lc, Player player);
+  // functions to spawn the doctor
+  void spawnDoctorRandomly(GameRandom &random);
+  void spawnDoctorSameRoom(GameRandom &random, const Player &player);
+  void spawnInRoom(GameRandom &random);
+  void spawnInSameRoom(GameRandom &random, const Player &player);
+
+  void isWaitingToChase(const Player &player, unsigned long now);
+  bool chase(const Player &player, unsigned long now);
   void levelUp();
 
-  // function to display the note in the room
-  void display(LedControl &lc, Player player);
-  void displayLevel(LiquidCrystal &lcd);
-  void reset();
+  void reset(GameRandom &random);
 };
 
 /*
   Spawn Dr. Nocturne in a random room.
 */
-void DrNocturne::spawnDoctorRandomly(){
-  currentRoom = random(0, roomsSize);  
-  spawnInRoom();
+void DrNocturne::spawnDoctorRandomly(GameRandom &random){
+  currentRoom = random.below(roomsSize);  
+  spawnInRoom(random);
 };
 
 /*
   Spawn Dr. Nocturne in the same room as the player's room.
 */
-void DrNocturne::spawnDoctorSameRoom(Player player){
+void DrNocturne::spawnDoctorSameRoom(GameRandom &random, const Player &player){
   currentRoom = player.currentRoom;
-  spawnInSameRoom(player);
+  spawnInSameRoom(random, player);
 };
 
 /*
   Generate a position in the currentRoom
   until it is a valid one. Spawn Dr. in that position.
 */
-void DrNocturne::spawnInRoom(){
-  row = random(0, matrixSize);
-  column = random(0, matrixSize);
+void DrNocturne::spawnInRoom(GameRandom &random){
+  row = random.below(matrixSize);
+  column = random.below(matrixSize);
 
   // generate row and column until
   // the position is different from a wall 
   while (rooms[currentRoom][row][column] == true){
-    row = random(0, matrixSize);
-    column = random(0, matrixSize);
+    row = random.below(matrixSize);
+    column = random.below(matrixSize);
   }
 };
 
 
-void DrNocturne::spawnInSameRoom(Player player){
-  row = random(0, matrixSize);
-  column = random(0, matrixSize);
+void DrNocturne::spawnInSameRoom(GameRandom &random, const Player &player){
+  row = random.below(matrixSize);
+  column = random.below(matrixSize);
 
-  // generate row and column until
-  // the position is different from a wall 
-  while (rooms[currentRoom][row][column] == true && player.row == row && player.column == column){
-    row = random(0, matrixSize);
-    column = random(0, matrixSize);
+  // generate row and column until the position is 
+  // different from a wall and from the player's position
+  while (rooms[currentRoom][row][column] == true || (player.row == row && player.column == column)){
+    row = random.below(matrixSize);
+    column = random.below(matrixSize);
   }
 }
 
@@ -103,13 +125,13 @@ void DrNocturne::spawnInSameRoom(Player player){
   and the Dr. needs to be:
 
   -> level 1: Dr. Nocturne is inactive
-  -> level 2: <= 5
-  -> level 3: <= 3
+  -> level 2: <= chaseDistance (5)
+  -> level 3: <= chaseDistanceLastLevel (3)
 
   When the player is close enough, Dr. Nocturne exits
   the waiting mode and enters in the chasing one.
 */
-void DrNocturne::isWaitingToChase(Player player){
+void DrNocturne::isWaitingToChase(const Player &player, unsigned long now){
   // if Dr. Nocturne and the player are not in 
   // the same room, exit
   if (currentRoom != player.currentRoom) {
@@ -117,86 +139,91 @@ void DrNocturne::isWaitingToChase(Player player){
     return;
   }
 
-  // calculate the euclidean distance between Dr and the player
-  float distance = euclideanDistance(player.row, player.column, row, column);
+  // calculate the squared distance between Dr and the player
+  int distance = squaredDistance(player.row, player.column, row, column);
 
   // level 2: start following the player when 
-  // the distance is at most 5
-  if (level == 2 && distance <= 5) {
+  // the distance is at most chaseDistance
+  if (level == 2 && distance <= tuning->chaseDistance * tuning->chaseDistance) {
     // deactivate the waiting state
     isWaiting = false;
     // activate the chasing state
     isChasing = true;
-    lastMovement = millis();
+    lastMovement = now;
   }
 
   // level 3: start following the player when 
-  // the distance is at most 3, which is harder than level 1
-  if (level == 3 && distance <= 3) {
+  // the distance is at most chaseDistanceLastLevel, which is harder than level 2
+  if (level == 3 && distance <= tuning->chaseDistanceLastLevel * tuning->chaseDistanceLastLevel) {
     // deactivate the waiting state
     isWaiting = false;
     // activate the chasing state
     isChasing = true;
-    lastMovement = millis();
+    lastMovement = now;
   }
 }
 
-void DrNocturne::chase(LedControl &lc, Player player){
+/*
+  Move Dr. Nocturne one cell closer to the player, if the
+  cooldown of the current level has passed. Returns true
+  if Dr. Nocturne has moved.
+*/
+bool DrNocturne::chase(const Player &player, unsigned long now){
   // depending on the level, Dr. Nocturne has a cooldown
   // between consecutive movements
   switch (level) {
     case 3:
-      if ((millis() - lastMovement) < movementCooldownLastLevel) {
-        return;
+      if ((now - lastMovement) < (unsigned long) tuning->movementCooldownLastLevel) {
+        return false;
       }
       break;
     default:
-      if ((millis() - lastMovement) < movementCooldown) {
-        return;
+      if ((now - lastMovement) < (unsigned long) tuning->movementCooldown) {
+        return false;
       }
       break;
   }
 
-  // set the old position to false, 
-  // to avoid letting the old position be active 
-  // in the same time with the new position
-  lc.setLed(0, row, column, false);
-  lastMovement = millis();
+  lastMovement = now;
 
-  // try to calculate the euclidean distance from each possible move
-  // to the player's current position; 
-  // set them as 100, in case a movement
-  // is not possible, its initial value cannot influence the minimum
-  float moveUp = 100, moveDown = 100, moveLeft = 100, moveRight = 100;
+  // calculate the distance from each possible move
+  // to the player's current position; set them as impossible,
+  // in case a movement is not possible, its initial value
+  // cannot influence the minimum
+  int moveUp = impossibleMoveDistance, moveDown = impossibleMoveDistance;
+  int moveLeft = impossibleMoveDistance, moveRight = impossibleMoveDistance;
 
-  // calculate the euclidean distance if the movement is a valid one,
+  // calculate the distance if the movement is a valid one,
   // aka it is not getting the doctor out of the matrix
   if (row - 1 >= 0) { 
     if (rooms[currentRoom][row - 1][column] == false) {
-      moveUp = euclideanDistance(player.row, player.column, row - 1, column);
+      moveUp = squaredDistance(player.row, player.column, row - 1, column);
     }
   } 
 
   if (row + 1 <= matrixSize - 1) { 
     if (rooms[currentRoom][row + 1][column] == false) {
-      moveDown = euclideanDistance(player.row, player.column, row + 1, column);
+      moveDown = squaredDistance(player.row, player.column, row + 1, column);
     }
   }
   
   if (column - 1 >= 0) { 
     if (rooms[currentRoom][row][column - 1] == false) {
-      moveLeft = euclideanDistance(player.row, player.column, row, column - 1);
+      moveLeft = squaredDistance(player.row, player.column, row, column - 1);
     }
   }
   
   if (column + 1 <= matrixSize - 1) {
     if (rooms[currentRoom][row ][column + 1] == false) {
-      moveRight = euclideanDistance(player.row, player.column, row, column + 1);
+      moveRight = squaredDistance(player.row, player.column, row, column + 1);
     }
   }
 
   // calculate the minimum between all 4 possible movements
-  float optimalMove = min(min(min(moveUp, moveDown), moveLeft), moveRight);
+  int optimalMove = moveUp;
+  if (moveDown < optimalMove) optimalMove = moveDown;
+  if (moveLeft < optimalMove) optimalMove = moveLeft;
+  if (moveRight < optimalMove) optimalMove = moveRight;
 
   // execute the movement
   if (optimalMove == moveUp) {
@@ -208,63 +235,19 @@ void DrNocturne::chase(LedControl &lc, Player player){
   } else {
     column += 1;
   }
+
+  return true;
 }
 
 void DrNocturne::levelUp(){
   level += 1;
 }
 
-/*
-  Display the current position of Dr. Nocturne
-  in the room, only if he is active AND in the same
-  room with the player.
-
-  It is visible for 500 ms and invisible for 100,
-  to make a blinking effect that is identical with the 
-  note's blinking effect.
-*/
-void DrNocturne::display(LedControl &lc, Player player){
-  // if the Doctor is not chasing, do not display his position
-  if (isWaiting == false && isChasing == false) {
-    return;
-  }
-
-  // if the note and the player are placed in different rooms, exit
-  if (currentRoom != player.currentRoom)
-    return;
-
-  // depending on the state of the note,
-  // check if the state should be toggled 
-  if (isDisplay) {
-    if ((millis() - noteDoctorActiveBlinkingInterval) > lastDisplayBlinking) {
-      lastDisplayBlinking = millis();
-      isDisplay = !isDisplay;
-      lc.setLed(0, row, column, isDisplay);
-    }
-  } else {
-    if ((millis() - noteDoctorInactiveBlinkingInterval) > lastDisplayBlinking) {
-      lastDisplayBlinking = millis();
-      isDisplay = !isDisplay;
-      lc.setLed(0, row, column, isDisplay);
-    }
-  }
-};
-
-void DrNocturne::displayLevel(LiquidCrystal &lcd){
-  lcd.setCursor(0, 0);
-  lcd.print("LVL");
-
-  lcd.setCursor(3, 0);
-  lcd.print(level);
-}
-
-void DrNocturne::reset(){
+void DrNocturne::reset(GameRandom &random){
   isWaiting = false;
   isChasing = false;
   level = 1;
-  spawnDoctorRandomly();
+  spawnDoctorRandomly(random);
 }
 
-
-
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,254 @@
+#pragma once
+#ifndef EEPROM_SCHEMA_H
+#define EEPROM_SCHEMA_H
+
+#include "EEPROM.h"
+
+#include "ConstantsHighscore.h"
+#include "Crc8.h"
+#include "EepromWriter.h"
+#include "Highscores.h"
+#include "Store.h"
+
+// where the settings are stored in the payload of the store
+const byte lcdBrightnessAddr = 0;
+const byte matrixBrightnessAddr = 1;
+const byte soundAddr = 2;
+
+// the settings of a new board, or of one whose EEPROM cannot be trusted
+const byte defaultLcdBrightness = 128;
+const byte defaultMatrixBrightness = 8;
+const byte defaultSound = 1;
+
+/*
+  The header at the start of the EEPROM: a magic number, the
+  version of the layout of everything after it, and the CRC-8
+  of both. Whoever changes the layout bumps the version and
+  adds the migration from the one before to schemaMigrations.
+
+  The versions:
+    0: the first layout, without a header: the settings at 0..2,
+       then 3 highscores of 7 bytes from 3 (the name, then the
+       time in seconds) and their number at 24
+    1: the header, the table of highscores at 64 and the store
+       after it
+*/
+const int schemaHeaderAddr = 0;
+const byte schemaMagic[2] = {'S', 'E'};
+const byte schemaVersion = 1;
+const byte schemaHeaderSize = 4;
+// the version of an EEPROM none of the layouts can be found in
+const byte schemaUnknown = 0xFF;
+
+// the first layout
+const byte firstLayoutSize = 25;
+const byte firstLayoutHighscores = 3;
+const byte firstLayoutHighscoreSize = 7;
+const byte firstLayoutNamesAddr = 3;
+const byte firstLayoutTimesAddr = 6;
+const byte firstLayoutRegisteredAddr = 24;
+
+/*
+  Time the board may take from its start to the first frame, in
+  microseconds, counted by micros() at the end of setup(). Most
+  of it goes to the LCD, whose start up waits 50 ms; the EEPROM
+  is usually only read: the header, the sequence numbers of the
+  store and one record, in about 1 ms.
+  A migration, or a new board, also has a few bytes written at
+  3.3 ms each, once, which can take the boot over it.
+*/
+const unsigned long bootTimeBudget = 100000;
+
+void migrateFirstLayout();
+
+typedef void (*SchemaMigration)();
+
+// the migration from every version to the one after it
+const SchemaMigration schemaMigrations[schemaVersion] = {
+  migrateFirstLayout,
+};
+
+// the header as it is written
+byte schemaHeader[schemaHeaderSize];
+EepromRequest schemaHeaderRequest;
+
+/*
+  Tell the first layout by its data, as it has no header: its
+  settings and its number of highscores are in their range. Its
+  matrix brightness, at most 15, is where the header has its
+  magic number, so the two are never mistaken.
+*/
+bool isFirstLayout(){
+  byte matrixBrightness = EEPROM.read(matrixBrightnessAddr);
+
+  return matrixBrightness >= 1 && matrixBrightness <= 15
+      && EEPROM.read(soundAddr) <= 1
+      && EEPROM.read(firstLayoutRegisteredAddr) <= firstLayoutHighscores;
+}
+
+/*
+  Returns true if the store's payload holds settings, and the
+  state of a table, in their range.
+*/
+bool hasStoredSettings(){
+  return store.payload[matrixBrightnessAddr] >= 1 && store.payload[matrixBrightnessAddr] <= 15
+      && store.payload[soundAddr] <= 1
+      && store.payload[highscoresRegisteredAddr] <= maximumHighscores
+      && store.payload[highscoresFreeAddr] < highscoreSlots
+      && (store.payload[highscoresRegisteredAddr] == maximumHighscores
+          || store.payload[highscoresFreeAddr] == store.payload[highscoresRegisteredAddr]);
+}
+
+/*
+  The version of the layout in EEPROM, from the header if its
+  CRC matches, or else from the bytes of the first layout, at
+  0..24; the store's area is not read for it.
+*/
+byte readSchemaVersion(){
+  byte header[schemaHeaderSize];
+
+  for (byte i = 0; i < schemaHeaderSize; i++) {
+    header[i] = EEPROM.read(schemaHeaderAddr + i);
+  }
+
+  if (header[0] == schemaMagic[0] && header[1] == schemaMagic[1]
+      && header[schemaHeaderSize - 1] == crc8(header, schemaHeaderSize - 1)) {
+    return header[2];
+  }
+
+  return isFirstLayout() ? 0 : schemaUnknown;
+}
+
+/*
+  Write the header of the current version, after the
+  bytes already queued, so it comes once they are there.
+*/
+void writeSchemaHeader(){
+  schemaHeader[0] = schemaMagic[0];
+  schemaHeader[1] = schemaMagic[1];
+  schemaHeader[2] = schemaVersion;
+  schemaHeader[schemaHeaderSize - 1] = crc8(schemaHeader, schemaHeaderSize - 1);
+
+  if (!eepromWriter.write(schemaHeaderRequest, schemaHeaderAddr, schemaHeader, schemaHeaderSize)) {
+    eepromWriter.flush();
+    eepromWriter.write(schemaHeaderRequest, schemaHeaderAddr, schemaHeader, schemaHeaderSize);
+  }
+}
+
+/*
+  Erase the sequence numbers of the store's slots but the newest
+  record's: the bytes another sketch left there could otherwise
+  pass for a newer record.
+*/
+void clearStoreSlots(){
+  store.flush();
+
+  for (byte i = 0; i < storeSlots; i++) {
+    if (i != store.slot && readStoreSequence(i) != storeErasedSequence) {
+      EEPROM.update(storeSlotAddr(i), 0xFF);
+      EEPROM.update(storeSlotAddr(i) + 1, 0xFF);
+    }
+  }
+}
+
+/*
+  Start over with the default settings and no highscores, the
+  bytes left from before are never read again.
+*/
+void formatEeprom(){
+  store.put(lcdBrightnessAddr, defaultLcdBrightness);
+  store.put(matrixBrightnessAddr, defaultMatrixBrightness);
+  store.put(soundAddr, defaultSound);
+  store.put(highscoresRegisteredAddr, (byte) 0);
+  store.put(highscoresFreeAddr, (byte) 0);
+  store.save();
+  clearStoreSlots();
+
+  writeSchemaHeader();
+}
+
+/*
+  From the first layout: the settings go to the store, and the
+  highscores to the table, their time from seconds to
+  centiseconds. The table is written right away, it only
+  happens once. The first layout stays as it is until the
+  store has its data, so a migration cut by a power loss is
+  done again from the start; then it is marked as migrated,
+  as the header written over it could be cut too.
+*/
+void migrateFirstLayout(){
+  for (byte i = 0; i <= soundAddr; i++) {
+    store.payload[i] = EEPROM.read(i);
+  }
+
+  byte registered = EEPROM.read(firstLayoutRegisteredAddr);
+
+  for (byte i = 0; i < registered; i++) {
+    char playerName[playerNameSize];
+    unsigned long seconds = 0;
+
+    for (byte letter = 0; letter < playerNameSize; letter++) {
+      playerName[letter] = EEPROM.read(firstLayoutNamesAddr + i * firstLayoutHighscoreSize + letter);
+    }
+    for (byte j = 0; j < 4; j++) {
+      seconds |= (unsigned long) EEPROM.read(firstLayoutTimesAddr + i * firstLayoutHighscoreSize + j) << (8 * j);
+    }
+
+    uint32_t record = packHighscore(playerName, seconds * 100);
+    for (byte j = 0; j < highscoreSize; j++) {
+      EEPROM.update(highscoreSlotAddr(i) + j, record >> (8 * j));
+    }
+  }
+
+  store.put(highscoresRegisteredAddr, registered);
+  // the table is full or the slot after the last one is free
+  store.put(highscoresFreeAddr, registered);
+  store.save();
+  clearStoreSlots();
+
+  // no longer a matrix brightness, the first byte of the header
+  // that could be, so the first layout is never taken again
+  EEPROM.update(matrixBrightnessAddr, schemaMagic[1]);
+}
+
+/*
+  Bring the EEPROM to the current layout and load the store,
+  at boot. Usually the header's CRC matches and the store is
+  loaded right away; the first layout is migrated in place, and
+  the header comes last, so a migration cut by a power loss is
+  done again. Anything else, like a new
+  board's erased EEPROM or the layout of a newer version, gets
+  the defaults.
+*/
+void loadEeprom(){
+  eepromWriter.flush();
+
+  byte version = readSchemaVersion();
+
+  // a migration cut while its header was written: the first
+  // layout is marked as migrated, the store has its data
+  if (version == schemaUnknown && store.load() && hasStoredSettings()) {
+    writeSchemaHeader();
+    return;
+  }
+
+  if (version == schemaVersion) {
+    if (!store.load()) {
+      formatEeprom();
+    }
+    return;
+  }
+
+  if (version > schemaVersion) {
+    formatEeprom();
+    return;
+  }
+
+  for (; version < schemaVersion; version++) {
+    schemaMigrations[version]();
+  }
+
+  writeSchemaHeader();
+}
+
+#endif
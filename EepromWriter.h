@@ -0,0 +1,178 @@
+#pragma once
+#ifndef EEPROM_WRITER_H
+#define EEPROM_WRITER_H
+
+#include "EEPROM.h"
+
+#include "Platform.h"
+
+// requests that can wait in the queue, a power of two;
+// one place is always left empty
+const byte eepromQueueSize = 8;
+
+/*
+  Bytes to write to EEPROM, from the caller's own buffer, which
+  must not change until the request is done. Only the bytes
+  that differ from the EEPROM's are written.
+*/
+struct EepromRequest{
+  int address;
+  const byte *bytes;
+  unsigned int size;
+  // bytes compared so far, moved on by the interrupt
+  volatile unsigned int position;
+  // the completion flag: set once every byte is written
+  volatile bool isDone;
+
+  EepromRequest(): address(0), bytes(NULL), size(0), position(0), isDone(true) {}
+};
+
+/*
+  Writes the EEPROM in the background: an EEPROM write takes
+  3.3 ms on the board, so the requests wait in a queue and the
+  EEPROM ready interrupt starts the next byte once the last one
+  is written, until the queue is empty. The loop never waits.
+
+  The interrupt also uses the EEPROM's address register, so the
+  loop only reads the EEPROM with the queue empty, after flush().
+  Elsewhere, update() writes the queued bytes from the loop.
+*/
+struct EepromWriter{
+  EepromRequest *queue[eepromQueueSize];
+  // the loop adds at the head, the interrupt takes at the tail
+  volatile byte head;
+  volatile byte tail;
+
+  EepromWriter(): head(0), tail(0) {}
+
+  byte freeSpace() const;
+  bool write(EepromRequest &request, int address, const byte bytes[], unsigned int size);
+  bool isIdle() const;
+  void tick();
+  void update();
+  void flush();
+};
+
+EepromWriter eepromWriter;
+
+#ifdef __AVR__
+
+ISR(EE_READY_vect){
+  eepromWriter.tick();
+}
+
+#endif
+
+byte EepromWriter::freeSpace() const{
+  return eepromQueueSize - 1 - ((head - tail) & (eepromQueueSize - 1));
+}
+
+/*
+  Queue the bytes to be written at the address. Returns false,
+  and leaves the request as it is, if the queue is full.
+*/
+bool EepromWriter::write(EepromRequest &request, int address, const byte bytes[], unsigned int size){
+  if (freeSpace() == 0) {
+    return false;
+  }
+
+  request.address = address;
+  request.bytes = bytes;
+  request.size = size;
+  request.position = 0;
+  request.isDone = false;
+
+  queue[head] = &request;
+  compilerBarrier();
+  head = (head + 1) & (eepromQueueSize - 1);
+
+#ifdef __AVR__
+  // fires right away if the EEPROM is ready
+  EECR |= (1 << EERIE);
+#endif
+
+  return true;
+}
+
+bool EepromWriter::isIdle() const{
+  return head == tail;
+}
+
+/*
+  The interrupt's own EEPROM access: the EEPROM is ready when it
+  runs, so a write only starts and the interrupt does not wait.
+*/
+byte readEepromByte(int address){
+#ifdef __AVR__
+  return eeprom_read_byte((const uint8_t *) address);
+#else
+  return EEPROM.read(address);
+#endif
+}
+
+void startEepromWrite(int address, byte value){
+#ifdef __AVR__
+  eeprom_write_byte((uint8_t *) address, value);
+#else
+  EEPROM.write(address, value);
+#endif
+}
+
+/*
+  Start writing the next byte that differs from the EEPROM's,
+  finishing the requests on the way. Runs in the interrupt.
+*/
+void EepromWriter::tick(){
+  while (tail != head) {
+    EepromRequest &request = *queue[tail];
+
+    while (request.position < request.size) {
+      unsigned int i = request.position;
+      byte value = request.bytes[i];
+      request.position += 1;
+
+      if (readEepromByte(request.address + i) != value) {
+        startEepromWrite(request.address + i, value);
+        return;
+      }
+    }
+
+    request.isDone = true;
+    tail = (tail + 1) & (eepromQueueSize - 1);
+  }
+
+#ifdef __AVR__
+  // nothing left to write, the interrupt would keep firing
+  EECR &= ~(1 << EERIE);
+#endif
+}
+
+/*
+  Write the queued bytes off the board, where the EEPROM is
+  always ready. The board's interrupt already does it.
+*/
+void EepromWriter::update(){
+#ifndef __AVR__
+  while (!isIdle()) {
+    tick();
+  }
+#endif
+}
+
+/*
+  Wait until every queued byte is written: before reading the
+  EEPROM, and before anything that resets the board or turns it
+  off, which would lose the bytes still waiting.
+*/
+void EepromWriter::flush(){
+  while (!isIdle()) {
+    update();
+  }
+
+#ifdef __AVR__
+  // the last write might still be going on
+  eeprom_busy_wait();
+#endif
+}
+
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include "Platform.h"
+
+/*
+  Fixed size ring of events, filled by one side (usually an
+  interrupt) and emptied by the other (usually the loop).
+
+  Each index is only written by one side and a byte is read
+  and written in a single instruction, so no locking is needed.
+  The capacity must be a power of two; one slot is always
+  kept empty to tell a full queue from an empty one.
+*/
+template <class Event, byte capacity>
+struct EventQueue{
+  Event events[capacity];
+  // next slot to write, only changed by push()
+  volatile byte head;
+  // next slot to read, only changed by pop()
+  volatile byte tail;
+  // events that did not fit, only changed by push()
+  volatile byte dropped;
+
+  EventQueue(): head(0), tail(0), dropped(0) {}
+
+  bool push(const Event &event);
+  bool pop(Event &event);
+  bool isEmpty() const;
+};
+
+/*
+  Add an event at the end of the queue.
+  Returns false, and drops the event, if the queue is full.
+*/
+template <class Event, byte capacity>
+bool EventQueue<Event, capacity>::push(const Event &event){
+  byte next = (head + 1) & (capacity - 1);
+
+  if (next == tail) {
+    dropped += 1;
+    return false;
+  }
+
+  events[head] = event;
+  compilerBarrier();
+  // publish the event only after it was written
+  head = next;
+  return true;
+}
+
+/*
+  Take the oldest event out of the queue.
+  Returns false if there is none.
+*/
+template <class Event, byte capacity>
+bool EventQueue<Event, capacity>::pop(Event &event){
+  if (tail == head) {
+    return false;
+  }
+
+  event = events[tail];
+  compilerBarrier();
+  // free the slot only after it was read
+  tail = (tail + 1) & (capacity - 1);
+  return true;
+}
+
+template <class Event, byte capacity>
+bool EventQueue<Event, capacity>::isEmpty() const{
+  return tail == head;
+}
+
+#endif
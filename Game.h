@@ -10,11 +10,14 @@
 #include "CustomCharacters.h"
 #include "MenuDisplay.h"
 #include "JoyStick.h"
-#include "Player.h"
-#include "Note.h"
-#include "DrNocturne.h"
+#include "GameState.h"
+#include "RoomsDisplay.h"
+#include "ConstantsBlinking.h"
 #include "Highscores.h"
+#include "ParTimes.h"
+#include "SavedGame.h"
 #include "Utils.h"
+#include "Scheduler.h"
 
 // duration of transition between messages
 const byte transitionTime = 100;
@@ -26,258 +29,339 @@ const int gameEndingTimeInterval = 3500;
 const byte heartsStartPosition = 13;
 // column position of the time in the live game menu
 const byte timePosition = 6;
-const byte notesNeedForWin = 6;
+// interval in ms between player's blinking position 
+const byte playerBlinkingInterval = 50;
+// steps made in one frame at most; after a longer stall
+// the game slows down instead of jumping forward
+const byte gameMaximumStepsPerFrame = 8;
 
-struct Game{
-  Player player;
-  Note note;
-  DrNocturne doctor;
-  
-  // time since the game started
-  unsigned long time;
-  // last time when the time was incremented
-  unsigned long lastTimeIncrement;
+// random numbers the board draws outside of the game rules, like
+// the seed of the next game; seeded once in setup(), so a
+// recorded run picks the same games when it is replayed
+GameRandom boardRandom;
+
+/*
+  The game as it is played on the device: the rules live in
+  GameState and move forward through step(), while this
+  struct feeds them the joystick and tickNow, and renders
+  the state on the matrix and on the LCD afterwards.
+*/
+struct Game : GameState{
+  // last time the game was stepped, in ms
+  unsigned long lastStepTime;
+  // time not stepped yet, in ms
+  unsigned int stepAccumulator;
+  // input waiting for the next step
+  GameInput pendingInput;
   // last time a note has been found
   unsigned long lastNoteFound;
   // last time the player has died
   unsigned long lastDeath;
+  // fastest possible escape for the seed being played, in ms
+  unsigned long parTime;
+  // index in parSeeds of the seed being played
+  byte parSeed;
 
-  bool isInPause = false;
-  bool isRunning = true;
   bool isDisplayingEndMessage = false;
+  // the game is played by the autoplayer, not by a person
+  bool isAutoPlaying = false;
 
   unsigned long gameEndingTime = 0;
+  // game time of the last level up, in ms
   unsigned long gameSpecialMomentsTime = 0;
   byte gameEndedMenuArrow = 0; 
 
-  Game(LedControl &lc): time(0), player(lc){
-    lastTimeIncrement = millis();
+  // positions drawn on the matrix during the last frame,
+  // used to turn off the LEDs that are left behind
+  byte displayedPlayerRow;
+  byte displayedPlayerColumn;
+  byte displayedDoctorRow;
+  byte displayedDoctorColumn;
+
+  // controls the player's visibility
+  bool isPlayerDisplayed;
+  // controls the note's and the Dr's visibility
+  bool isNoteDisplayed;
+  bool isDoctorDisplayed;
+  // game time when the visibility changed its state, in ms;
+  // like the rest of the game, the blinking stops in pause
+  unsigned long lastPlayerBlinking;
+  unsigned long lastNoteBlinking;
+  unsigned long lastDoctorBlinking;
+
+  Game(): lastStepTime(0), stepAccumulator(0), lastNoteFound(0), lastDeath(0), parTime(0), parSeed(0){
+    isPlayerDisplayed = true;
+    isNoteDisplayed = false;
+    isDoctorDisplayed = false;
+
+    lastPlayerBlinking = 0;
+    lastNoteBlinking = 0;
+    lastDoctorBlinking = 0;
   }
 
-  // functions to control the state of game
-  void checkPlayerFoundNote(LiquidCrystal &lcd);
-  void checkPlayerWasFoundByDoctor(LiquidCrystal &lcd);
-  void checkPlayerWon(LedControl &lc, LiquidCrystal &lcd);
-  void checkPlayerLost(LedControl &lc, LiquidCrystal &lcd);
   bool checkPlayerGotHighscore();
 
   // functions to display the game on the LCD
   void play(LedControl &lc, LiquidCrystal &lcd, Joystick &joystick);
+  void play(LedControl &lc, LiquidCrystal &lcd, const GameInput &input);
+  void render(LedControl &lc, LiquidCrystal &lcd);
+  void renderEvents(LedControl &lc, LiquidCrystal &lcd);
+
+  // functions to display the game on the matrix
+  void displayPlayer(LedControl &lc);
+  void displayNote(LedControl &lc);
+  void displayDoctor(LedControl &lc);
 
   // functions to display game status while running
-  void displayGameRunningMenu(LedControl &lc, LiquidCrystal &lcd);
+  void displayGameRunningMenu(LiquidCrystal &lcd);
   void displayTime(LiquidCrystal &lcd, const int line);
-  void increaseTime();
+  void displayNotes(LiquidCrystal &lcd);
+  void displayLives(LiquidCrystal &lcd, byte heartsStartPosition, const int line);
+  void displayLevel(LiquidCrystal &lcd);
   
   // function to handle pause mode
-  void gamePauseHandler(LiquidCrystal &lcd, Joystick &joystick);
   void displayPauseMode(LiquidCrystal &lcd);
 
   // functions to handle end of the game
   void displayGameEnded(LedControl &lc, LiquidCrystal &lcd);
   void displayGameEndedMessage(LiquidCrystal &lcd);  
+  void displayParDifference(LiquidCrystal &lcd, const byte column, const byte line);
   void displayPlayerGotHighscore(LiquidCrystal &lcd);
   void displayPlayerEntersName(LiquidCrystal &lcd);
 
-  // function to reset the game
+  // functions to save and continue the game
+  void saveAtSafePoints();
+  bool restore(LedControl &lc);
+
+  // functions to reset the game
   void reset(LedControl &lc);
+  void resetDisplay(LedControl &lc);
 };
 
-void Game::checkPlayerFoundNote(LiquidCrystal &lcd){
-  // if the player and the note are in different rooms, exit
-  if (player.currentRoom != note.currentRoom)
-    return;
+bool Game::checkPlayerGotHighscore(){
+  // the same check the table makes before putting it in
+  return isHighscore(centiseconds());
+}
 
-  // if the player and the note are not on the same position, exit
-  if (player.row != note.row || player.column != note.column) 
+
+/*
+  Step the game rules with the joystick's input, in fixed
+  steps of gameStepInterval for the time passed since the last
+  frame, then render the new state: the game status while
+  running, the pause mode, or the game ending messages.
+*/
+void Game::play(LedControl &lc, LiquidCrystal &lcd, Joystick &joystick){  
+  play(lc, lcd, GameInput(joystick.direction, joystick.currentSwitchStateChanged == HIGH));
+};
+
+void Game::play(LedControl &lc, LiquidCrystal &lcd, const GameInput &input){
+  // keep the input until a step uses it
+  if (input.direction != joystickNone) {
+    pendingInput.direction = input.direction;
+  }
+  if (input.switchPressed) {
+    pendingInput.switchPressed = true;
+  }
+
+  stepAccumulator += tickNow - lastStepTime;
+  lastStepTime = tickNow;
+
+  // the events of all the steps of this frame are rendered together
+  byte frameEvents = 0;
+  byte steps = 0;
+
+  while (stepAccumulator >= gameStepInterval && steps < gameMaximumStepsPerFrame) {
+    step(*this, pendingInput, gameStepInterval);
+    pendingInput = GameInput();
+
+    frameEvents |= events;
+    stepAccumulator -= gameStepInterval;
+    steps += 1;
+  }
+
+  if (stepAccumulator >= gameStepInterval) {
+    stepAccumulator = 0;
+  }
+
+  events = frameEvents;
+  saveAtSafePoints();
+
+  render(lc, lcd);
+};
+
+/*
+  Draw the current state of the game. This only reads
+  the state, the rules already moved forward in step().
+*/
+void Game::render(LedControl &lc, LiquidCrystal &lcd){
+  renderEvents(lc, lcd);
+
+  if (isInPause) {
+    displayPauseMode(lcd);
     return;
+  }
 
-  // if this section of the function was reached, it means
-  // that the player has found the note
-  player.notes += 1;
-  lastNoteFound = millis();
+  if (isRunning) {
+    // display the menu on the LCD constantly
+    displayGameRunningMenu(lcd);
+
+    // while Dr. Nocturne is active, he is displayed
+    // instead of the note
+    if (doctor.isWaiting == true || doctor.isChasing == true) {
+      displayDoctor(lc);
+    } else {
+      displayNote(lc);
+    }
 
-  // if the player already collected 3 notes,
-  // make sure the note spawns in a different room 
-  // from the room the player is currently in
-  if (player.notes >= 3) {
-    note.spawnNoteDifferentRoom(player.currentRoom);
+    // display player constantly
+    displayPlayer(lc);
   } 
-  // otherwise, just spawn the note randomly
-  else {
-    note.spawnNoteRandomly();
+    
+  if (isDisplayingEndMessage) {
+    displayGameEnded(lc, lcd);
   }
+};
 
-  // when the player reaches 2 / 4 notes, a special message
-  // will be displayed on the LCD and the level will be increased
-  if (player.notes == 2 || player.notes == 4) {
+/*
+  React to what happened during the last step:
+  clear the LCD between messages, redraw the room,
+  and remember when the sounds should be played.
+*/
+void Game::renderEvents(LedControl &lc, LiquidCrystal &lcd){
+  if (events & eventPauseToggled) {
     lcd.clear();
-    doctor.levelUp();
-    gameSpecialMomentsTime = millis();
   }
 
-  // if the user reached 2 notes, spawn Dr. Nocturne,
-  // and until reaching 4 notes, the Dr. spawns randomly
-  if (player.notes >= 2 && player.notes <= 3) {
-    doctor.spawnDoctorRandomly();
-    doctor.isWaiting = true;
+  // the player left through a door, so display the new room
+  if (events & eventRoomChanged) {
+    roomDrawing.start(lc, player.currentRoom);
+  } 
+  // otherwise, unset the position the player left
+  else if (displayedPlayerRow != player.row || displayedPlayerColumn != player.column) {
+    lc.setLed(0, displayedPlayerRow, displayedPlayerColumn, false);
   }
 
-  // for the last two notes, the doctor will spawn in the
-  // same room with the player
-  if (player.notes >= 4 && player.notes <= 5) {
-    doctor.spawnDoctorSameRoom(player);
-    doctor.isWaiting = true;
+  displayedPlayerRow = player.row;
+  displayedPlayerColumn = player.column;
+
+  // set the old position of the doctor to false, 
+  // to avoid letting the old position be active 
+  // in the same time with the new position
+  if (events & eventDoctorMoved) {
+    if (doctor.currentRoom == player.currentRoom) {
+      lc.setLed(0, displayedDoctorRow, displayedDoctorColumn, false);
+      lc.setLed(0, doctor.row, doctor.column, isDoctorDisplayed);
+    }
   }
-}
 
-void Game::checkPlayerWasFoundByDoctor(LiquidCrystal &lcd){
-  // if the player and the doctor are in the same room,
-  // in the same position, it means the player was found
-  if (player.currentRoom == doctor.currentRoom && player.row == doctor.row && player.column == doctor.column) {
-    // firstly clear the lcd, than
-    // decrease the number of lives
-    lcd.clear();
-    player.lives -= 1;
-    // make the doctor inactive
-    doctor.isWaiting = false;
-    doctor.isChasing = false;
-    lastDeath = millis();
+  displayedDoctorRow = doctor.row;
+  displayedDoctorColumn = doctor.column;
+
+  if (events & eventNoteFound) {
+    lastNoteFound = tickNow;
   }
-}
 
-void Game::checkPlayerWon(LedControl &lc, LiquidCrystal &lcd){
-  // check if the number of notes reached the number
-  // needed for the player to win
-  if (player.notes == notesNeedForWin) {
-    gameEndingTime = millis();
-    // clear the matrix
-    resetMatrix(lc);
-    // clear the menu LCD
+  // when the player reaches 2 / 4 notes, a special message
+  // will be displayed on the LCD
+  if (events & eventLevelUp) {
     lcd.clear();
-    
-    isRunning = false;
-    isDisplayingEndMessage = true;
+    gameSpecialMomentsTime = now;
+  }
 
-    player.isWinning = true;
-    // check if the player got an highscore
-    player.hasHighscore = checkPlayerGotHighscore();
+  if (events & eventPlayerDied) {
+    lcd.clear();
+    lastDeath = tickNow;
   }
-}
 
-void Game::checkPlayerLost(LedControl &lc, LiquidCrystal &lcd){
-  // if the player has no lives left, it means that he lost
-  if (player.lives == 0) {
-    gameEndingTime = millis();
+  if (events & eventGameEnded) {
+    gameEndingTime = tickNow;
     // clear the matrix
     resetMatrix(lc);
     // clear the menu LCD
     lcd.clear();
 
-    isRunning = false;
     isDisplayingEndMessage = true;
-  }
-}
-
-bool Game::checkPlayerGotHighscore(){
-    // if highscores have not been completed
-  if (highscoresRegistered < 3) {
-    highscoresRegistered += 1;
-    return true;
-  }
 
-  // loop the current highscores and check if the player
-  // surpassed other scores
-  for (int i = 0; i < highscoresRegistered; i++) {
-    // check if player surpassed ith score
-    if (time < highscores[i]) {
-      return true;
+    // check if the player got an highscore; the
+    // autoplayer's games do not make it in the table
+    if (player.isWinning && !isAutoPlaying) {
+      player.hasHighscore = checkPlayerGotHighscore();
     }
   }
-
-  return false;
-}
-
+};
 
 /*
-  If the game is running, display the game status
-  on the LCD screen. Also, listen to joystick movements
-  from the player, check if it has found any notes and if
-  it might have won.
-
-  Otherwise, display a game ending message.
+  Display the current position of the player in
+  a blinking mode. Once 50 ms. make the player blink
+  so it is easily distinguishable.
 */
-void Game::play(LedControl &lc, LiquidCrystal &lcd, Joystick &joystick){  
-  // before playing the game, check if the user pressed
-  // the SW in the joystick aka made a pause
-  gamePauseHandler(lcd, joystick);
+void Game::displayPlayer(LedControl &lc){
+  if ((now - lastPlayerBlinking) > playerBlinkingInterval) {
+    lastPlayerBlinking = now;
+    isPlayerDisplayed = !isPlayerDisplayed;
+    lc.setLed(0, player.row, player.column, isPlayerDisplayed);
+  }
+};
 
-  if (isInPause) {
-    displayPauseMode(lcd);
+/*
+  Display the current position of the note 
+  in the room. 
+  
+  It is visible for 500 ms and invisible for 100,
+  to make a blinking effect that is not similar with the blinking effect
+  of the player. 
+*/
+void Game::displayNote(LedControl &lc){
+  // if the note and the player are placed in different rooms, exit
+  if (note.currentRoom != player.currentRoom)
     return;
+
+  // depending on the state of the note,
+  // check if the state should be toggled 
+  unsigned long interval = isNoteDisplayed ? noteDoctorActiveBlinkingInterval : noteDoctorInactiveBlinkingInterval;
+
+  if ((now - lastNoteBlinking) > interval) {
+    lastNoteBlinking = now;
+    isNoteDisplayed = !isNoteDisplayed;
+    lc.setLed(0, note.row, note.column, isNoteDisplayed);
   }
+};
 
-  if (isRunning) {
-    // display the menu on the LCD constantly
-    displayGameRunningMenu(lc, lcd);
-    // listens to the position change of the player
-    player.movementWatcher(lc, joystick);
-
-    // if the doctor waits to chase the player
-    if (doctor.isWaiting == true) {
-      doctor.isWaitingToChase(player);
-      doctor.display(lc, player);
-    } 
-
-    // if the doctor is chasing the player
-    if (doctor.isChasing == true) {
-      // if the player escaped from the room where the
-      // doctor was, the doctor stops chasing and becomes inactive
-      if (player.currentRoom != doctor.currentRoom) {
-        doctor.isChasing = false;
-      }
-
-      // doctor is chasing the player
-      doctor.chase(lc, player);
-      // check if the player was found by the doctor
-      checkPlayerWasFoundByDoctor(lcd);
-
-      doctor.display(lc, player);
-    }
+/*
+  Display the current position of Dr. Nocturne
+  in the room, only if he is in the same
+  room with the player.
 
-    // if the doctor is inactive, display the note and
-    // check if it was found by the player
-    if (doctor.isWaiting == false && doctor.isChasing == false) {
-      note.display(lc, player);
-      // check if the player found any notes
-      checkPlayerFoundNote(lcd);
-    }
+  It is visible for 500 ms and invisible for 100,
+  to make a blinking effect that is identical with the 
+  note's blinking effect.
+*/
+void Game::displayDoctor(LedControl &lc){
+  // if the doctor and the player are placed in different rooms, exit
+  if (doctor.currentRoom != player.currentRoom)
+    return;
 
-    // at every step, check if 
-    // the player is winning or losing
-    checkPlayerWon(lc, lcd);
-    checkPlayerLost(lc, lcd);
+  // depending on the state of the doctor,
+  // check if the state should be toggled 
+  unsigned long interval = isDoctorDisplayed ? noteDoctorActiveBlinkingInterval : noteDoctorInactiveBlinkingInterval;
 
-    // increase time and display player constantly
-    increaseTime();
-    player.display(lc);
-  } 
-    
-  if (isDisplayingEndMessage) {
-    displayGameEnded(lc, lcd);
+  if ((now - lastDoctorBlinking) > interval) {
+    lastDoctorBlinking = now;
+    isDoctorDisplayed = !isDoctorDisplayed;
+    lc.setLed(0, doctor.row, doctor.column, isDoctorDisplayed);
   }
 };
 
-void Game::displayGameRunningMenu(LedControl &lc, LiquidCrystal &lcd){
+void Game::displayGameRunningMenu(LiquidCrystal &lcd){
   // display a special message when the player reached level 2
-  if ((millis() - gameSpecialMomentsTime) < gameSpecialMomentsTimeInterval && player.notes == 2) {
+  if ((now - gameSpecialMomentsTime) < gameSpecialMomentsTimeInterval && player.notes == 2) {
     displayMessageInCenter(lcd, "Dr. Nocturne", 0);
     displayMessageInCenter(lcd, "was spawned...", 1);
     return;
   }
 
   // display a special message when the player reached level 3
-  if ((millis() - gameSpecialMomentsTime) < gameSpecialMomentsTimeInterval && player.notes == 4) {
+  if ((now - gameSpecialMomentsTime) < gameSpecialMomentsTimeInterval && player.notes == 4) {
     displayMessageInCenter(lcd, "Dr. Nocturne", 0);
     displayMessageInCenter(lcd, "is faster...", 1);
     return;
@@ -285,51 +369,52 @@ void Game::displayGameRunningMenu(LedControl &lc, LiquidCrystal &lcd){
 
   // make a smooth transition between the special message
   // and the game menu
-  if ((millis() - gameSpecialMomentsTime) >= gameSpecialMomentsTimeInterval 
-  && (millis() - gameSpecialMomentsTime) <= gameSpecialMomentsTimeInterval + transitionTime) {
+  if ((now - gameSpecialMomentsTime) >= gameSpecialMomentsTimeInterval 
+  && (now - gameSpecialMomentsTime) <= gameSpecialMomentsTimeInterval + transitionTime) {
     lcd.clear();
   }
 
   // display the usual game menu
-  player.displayLives(lcd, heartsStartPosition, 0);
-  player.displayNotes(lcd);
-  doctor.displayLevel(lcd);
+  displayLives(lcd, heartsStartPosition, 0);
+  displayNotes(lcd);
+  displayLevel(lcd);
   displayTime(lcd, 0);
 };
 
 void Game::displayTime(LiquidCrystal &lcd, const int line){
-  displayTimeFromSeconds(lcd, time, timePosition, line);
+  displayTimeFromSeconds(lcd, seconds(), timePosition, line);
 };
 
-void Game::increaseTime(){
-  // if 1000 ms have passed, it means a second,
-  // so the time will be incremented by 1
-  if ((millis() - lastTimeIncrement) >= 1000) {
-    lastTimeIncrement = millis();
-    time += 1;
-  }
-}
+void Game::displayNotes(LiquidCrystal &lcd){
+  lcd.setCursor(0, 1);
+  lcd.print("Notes:");
 
+  // 7 is the length of "Notes "
+  lcd.setCursor(7, 1);
+  lcd.print(player.notes);
+};
 
-void Game::gamePauseHandler(LiquidCrystal &lcd, Joystick &joystick){
-  // if the SW button was pressed, toggle the pause variable
-  if (joystick.currentSwitchStateChanged == HIGH) {
-    lcd.clear();
-    // reset the last time when the time was incremented because it does
-    // not need to take into account the MS during the pause mode
-    lastTimeIncrement = millis();
+void Game::displayLives(LiquidCrystal &lcd, byte heartsStartPosition, const int line){
+  for(int i = 0; i < player.lives; i++) {
+    lcd.setCursor(heartsStartPosition + i, line);
+    lcd.write(heartIndex);
+  }
+};
 
-    // toggle the pause variable
-    isInPause = !isInPause;
-  } 
+void Game::displayLevel(LiquidCrystal &lcd){
+  lcd.setCursor(0, 0);
+  lcd.print("LVL");
+
+  lcd.setCursor(3, 0);
+  lcd.print(doctor.level);
 }
 
 void Game::displayPauseMode(LiquidCrystal &lcd){
   displayMessageInCenter(lcd, " PAUSE", 1);
   displayTime(lcd, 0);
 
-  player.displayLives(lcd, heartsStartPosition, 0);
-  doctor.displayLevel(lcd);
+  displayLives(lcd, heartsStartPosition, 0);
+  displayLevel(lcd);
 }
 
 
@@ -344,32 +429,32 @@ void Game::displayPauseMode(LiquidCrystal &lcd){
 */
 void Game::displayGameEnded(LedControl &lc,  LiquidCrystal &lcd){
   // for 3 seconds the game endings message will be displayed
-  if ((millis() - gameEndingTime) < gameEndingTimeInterval) {
+  if ((tickNow - gameEndingTime) < gameEndingTimeInterval) {
     displayGameEndedMessage(lcd);
     return;
   } 
   // after that, a smooth 500 ms transition will be made,
   // in which the LCD will be cleared
-  else if ((millis() - gameEndingTime) >= gameEndingTimeInterval 
-          && (millis() - gameEndingTime) <= gameEndingTimeInterval + transitionTime) {
+  else if ((tickNow - gameEndingTime) >= gameEndingTimeInterval 
+          && (tickNow - gameEndingTime) <= gameEndingTimeInterval + transitionTime) {
     lcd.clear();
     return;
   } 
 
-  if ((millis() - gameEndingTime) < (gameEndingTimeInterval * 2 + transitionTime)
+  if ((tickNow - gameEndingTime) < (gameEndingTimeInterval * 2 + transitionTime)
       && player.hasHighscore) { 
       displayPlayerGotHighscore(lcd);
       return;
   } 
   // after that, a smooth 500 ms transition will be made,
   // in which the LCD will be cleared
-  else if ((millis() - gameEndingTime) >= (gameEndingTimeInterval * 2 + transitionTime)
-          && (millis() - gameEndingTime) <= 2 * (gameEndingTimeInterval + transitionTime)) {
+  else if ((tickNow - gameEndingTime) >= (gameEndingTimeInterval * 2 + transitionTime)
+          && (tickNow - gameEndingTime) <= 2 * (gameEndingTimeInterval + transitionTime)) {
     lcd.clear();
     return;
   } 
 
-  if ((millis() - gameEndingTime) < (gameEndingTimeInterval * 3 + transitionTime)
+  if ((tickNow - gameEndingTime) < (gameEndingTimeInterval * 3 + transitionTime)
       && player.hasHighscore
       && !player.hasUserName) { 
       displayPlayerEntersName(lcd);
@@ -387,15 +472,32 @@ void Game::displayGameEnded(LedControl &lc,  LiquidCrystal &lcd){
 void Game::displayGameEndedMessage(LiquidCrystal &lcd){
   if (player.isWinning) {
     displayMessageInCenter(lcd, "You escaped!", 0);
+    // show how far the player was from the fastest escape
+    displayTimeFromSeconds(lcd, seconds(), 1, 1);
+    displayParDifference(lcd, 7, 1);
   } else {
     displayMessageInCenter(lcd, "You died!", 0);
+    displayTimeFromSeconds(lcd, seconds(), 5, 1);
   }
-  displayTimeFromSeconds(lcd, time, 5, 1);
+}
+
+/*
+  Display the difference between the player's time and 
+  the par time of the seed, e.g. "par +12s".
+*/
+void Game::displayParDifference(LiquidCrystal &lcd, const byte column, const byte line){
+  long difference = (long) seconds() - (long) (parTime / 1000);
+
+  lcd.setCursor(column, line);
+  lcd.print("par ");
+  lcd.print(difference < 0 ? "-" : "+");
+  lcd.print(difference < 0 ? -difference : difference);
+  lcd.print("s");
 }
 
 void Game::displayPlayerGotHighscore(LiquidCrystal &lcd){
   displayMessageInCenter(lcd, "New highscore!", 0);
-  displayTimeFromSeconds(lcd, time, 5, 1);
+  displayTimeFromCentiseconds(lcd, centiseconds(), 4, 1);
 }
 
 void Game::displayPlayerEntersName(LiquidCrystal &lcd){
@@ -404,17 +506,85 @@ void Game::displayPlayerEntersName(LiquidCrystal &lcd){
 }
 
 /*
-  Reset all the game variables.
+  Save the game in EEPROM when it is paused, when a note is
+  found and when the player dies, so it can be continued
+  after the board was turned off. Once the game has ended,
+  there is nothing left to continue.
+*/
+void Game::saveAtSafePoints(){
+  // the autoplayer's games are not worth continuing
+  if (isAutoPlaying) {
+    return;
+  }
+
+  if (events & eventGameEnded) {
+    clearSavedGame();
+    return;
+  }
+
+  if (((events & eventPauseToggled) && isInPause) || (events & (eventNoteFound | eventPlayerDied))) {
+    GameSnapshot snapshot;
+    snapshot.pack(*this, parSeed);
+    writeSavedGame(snapshot);
+  }
+};
+
+/*
+  Continue the game saved in EEPROM, in pause mode.
+  Returns false if there is no saved game.
+*/
+bool Game::restore(LedControl &lc){
+  GameSnapshot snapshot;
+
+  if (!readSavedGame(snapshot) || !snapshot.unpack(*this, parSeed)) {
+    return false;
+  }
+
+  // the par times might have been generated again since
+  if (parSeed >= parSeedsSize) {
+    parSeed = 0;
+  }
+  parTime = pgm_read_dword(&parSeeds[parSeed].parTime);
+
+  isDisplayingEndMessage = false;
+  resetDisplay(lc);
+  return true;
+};
+
+/*
+  Start a new game from one of the seeds with a known
+  par time and display the room the player spawned in.
 */
 void Game::reset(LedControl &lc){
-  time = 0;
-  lastTimeIncrement = millis();
-  
-  isRunning = true;
+  parSeed = boardRandom.below(parSeedsSize);
+  parTime = pgm_read_dword(&parSeeds[parSeed].parTime);
 
-  doctor.reset();
-  player.reset(lc);
-  note.spawnNoteRandomly();
+  GameState::reset(pgm_read_dword(&parSeeds[parSeed].seed));
+  resetDisplay(lc);
+};
+
+/*
+  Draw the room of the player and start
+  tracking what is displayed on the matrix.
+*/
+void Game::resetDisplay(LedControl &lc){
+  lastStepTime = tickNow;
+  stepAccumulator = 0;
+  pendingInput = GameInput();
+
+  roomDrawing.start(lc, player.currentRoom);
+  displayedPlayerRow = player.row;
+  displayedPlayerColumn = player.column;
+  displayedDoctorRow = doctor.row;
+  displayedDoctorColumn = doctor.column;
+  isPlayerDisplayed = true;
+
+  // the game clock starts again from the new state
+  lastPlayerBlinking = now;
+  lastNoteBlinking = now;
+  lastDoctorBlinking = now;
+  // and no level up message is left to show
+  gameSpecialMomentsTime = now - gameSpecialMomentsTimeInterval - transitionTime - 1;
 };
 
 #endif
\ No newline at end of file
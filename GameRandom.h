@@ -0,0 +1,43 @@
+#pragma once
+#ifndef GAME_RANDOM_H
+#define GAME_RANDOM_H
+
+#include "Platform.h"
+
+/*
+  Small xorshift generator owned by the game state.
+
+  Every spawn in the game draws from it, so a game
+  is completely determined by its seed and the input,
+  on the board as well as on the host.
+*/
+struct GameRandom{
+  uint32_t state;
+
+  GameRandom(): state(1) {}
+
+  void seed(uint32_t seed);
+  uint32_t next();
+  byte below(byte maximum);
+};
+
+void GameRandom::seed(uint32_t seed){
+  // xorshift gets stuck on 0, so replace it with any other value
+  state = seed != 0 ? seed : 0x9E3779B9UL;
+};
+
+uint32_t GameRandom::next(){
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+};
+
+/*
+  Generate a number in the [0, maximum) interval.
+*/
+byte GameRandom::below(byte maximum){
+  return next() % maximum;
+};
+
+#endif
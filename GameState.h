@@ -0,0 +1,252 @@
+#pragma once
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include "Platform.h"
+#include "Directions.h"
+#include "GameRandom.h"
+#include "Rooms.h"
+#include "Player.h"
+#include "Note.h"
+#include "DrNocturne.h"
+
+// number of notes the player needs to collect to escape
+const byte notesNeedForWin = 6;
+// the game rules always move forward by this much, in ms
+const byte gameStepInterval = 10;
+
+/*
+  Everything the game rules need from the outside world
+  during one step: where the joystick points and if its
+  switch was pressed.
+*/
+struct GameInput{
+  byte direction;
+  bool switchPressed;
+
+  GameInput(): direction(joystickNone), switchPressed(false) {}
+  GameInput(byte direction, bool switchPressed): direction(direction), switchPressed(switchPressed) {}
+};
+
+// events raised during a step, so the rendering knows
+// what changed without comparing the whole state
+const byte eventPauseToggled = 1;
+const byte eventRoomChanged = 2;
+const byte eventNoteFound = 4;
+const byte eventLevelUp = 8;
+const byte eventPlayerDied = 16;
+const byte eventDoctorMoved = 32;
+const byte eventGameEnded = 64;
+
+/*
+  The whole simulation of the game: the player, the note,
+  Dr. Nocturne, the time and the random generator.
+
+  It does not know anything about the LCD, the matrix
+  or millis(); it only changes through step().
+*/
+struct GameState{
+  Player player;
+  Note note;
+  DrNocturne doctor;
+  GameRandom random;
+
+  // game clock: the ms the game was running for, gathered
+  // exactly from every step; it stands still during the pause
+  unsigned long now;
+
+  bool isInPause;
+  bool isRunning;
+
+  // events raised by the last step
+  byte events;
+
+  GameState(): now(0), isInPause(false), isRunning(false), events(0) {}
+
+  // functions to control the state of game
+  void checkPlayerFoundNote();
+  void checkPlayerWasFoundByDoctor();
+  void checkPlayerWon();
+  void checkPlayerLost();
+
+  // functions to read the game clock
+  unsigned long seconds() const;
+  unsigned long centiseconds() const;
+
+  // function to start a new game from the given seed
+  void reset(uint32_t seed);
+};
+
+void GameState::checkPlayerFoundNote(){
+  // if the player and the note are in different rooms, exit
+  if (player.currentRoom != note.currentRoom)
+    return;
+
+  // if the player and the note are not on the same position, exit
+  if (player.row != note.row || player.column != note.column)
+    return;
+
+  // if this section of the function was reached, it means
+  // that the player has found the note
+  player.notes += 1;
+  events |= eventNoteFound;
+
+  // if the player already collected 3 notes,
+  // make sure the note spawns in a different room
+  // from the room the player is currently in
+  if (player.notes >= 3) {
+    note.spawnNoteDifferentRoom(random, player.currentRoom);
+  }
+  // otherwise, just spawn the note randomly
+  else {
+    note.spawnNoteRandomly(random);
+  }
+
+  // when the player reaches 2 / 4 notes,
+  // the level will be increased
+  if (player.notes == 2 || player.notes == 4) {
+    doctor.levelUp();
+    events |= eventLevelUp;
+  }
+
+  // if the user reached 2 notes, spawn Dr. Nocturne,
+  // and until reaching 4 notes, the Dr. spawns randomly
+  if (player.notes >= 2 && player.notes <= 3) {
+    doctor.spawnDoctorRandomly(random);
+    doctor.isWaiting = true;
+  }
+
+  // for the last two notes, the doctor will spawn in the
+  // same room with the player
+  if (player.notes >= 4 && player.notes <= 5) {
+    doctor.spawnDoctorSameRoom(random, player);
+    doctor.isWaiting = true;
+  }
+}
+
+void GameState::checkPlayerWasFoundByDoctor(){
+  // if the player and the doctor are in the same room,
+  // in the same position, it means the player was found
+  if (player.currentRoom == doctor.currentRoom && player.row == doctor.row && player.column == doctor.column) {
+    // decrease the number of lives
+    player.lives -= 1;
+    // make the doctor inactive
+    doctor.isWaiting = false;
+    doctor.isChasing = false;
+    events |= eventPlayerDied;
+  }
+}
+
+void GameState::checkPlayerWon(){
+  // check if the number of notes reached the number
+  // needed for the player to win
+  if (player.notes == notesNeedForWin) {
+    isRunning = false;
+    player.isWinning = true;
+    events |= eventGameEnded;
+  }
+}
+
+void GameState::checkPlayerLost(){
+  // if the player has no lives left, it means that he lost
+  if (player.lives == 0) {
+    isRunning = false;
+    events |= eventGameEnded;
+  }
+}
+
+unsigned long GameState::seconds() const{
+  return now / 1000;
+}
+
+/*
+  The scores are kept in centiseconds, so two
+  escapes in the same second rarely tie.
+*/
+unsigned long GameState::centiseconds() const{
+  return now / 10;
+}
+
+/*
+  Reset all the game variables and spawn
+  everything again, starting from the given seed.
+*/
+void GameState::reset(uint32_t seed){
+  random.seed(seed);
+
+  now = 0;
+
+  isInPause = false;
+  isRunning = true;
+  events = 0;
+
+  player.reset(random);
+  doctor.reset(random);
+  note.spawnNoteRandomly(random);
+}
+
+/*
+  Advance the game by dt ms, with the given input.
+
+  This is the only way the game rules move forward; it does
+  not call any hardware function, so the same step runs
+  on the board and on the host.
+*/
+void step(GameState &state, const GameInput &input, unsigned int dt){
+  state.events = 0;
+
+  // the switch toggles the pause while the game is running
+  if (input.switchPressed && state.isRunning) {
+    state.isInPause = !state.isInPause;
+    state.events |= eventPauseToggled;
+  }
+
+  if (state.isInPause || !state.isRunning) {
+    return;
+  }
+
+  state.now += dt;
+
+  // listens to the position change of the player
+  byte previousRoom = state.player.currentRoom;
+  state.player.movementWatcher(input.direction);
+
+  if (state.player.currentRoom != previousRoom) {
+    state.events |= eventRoomChanged;
+  }
+
+  // if the doctor waits to chase the player
+  if (state.doctor.isWaiting == true) {
+    state.doctor.isWaitingToChase(state.player, state.now);
+  }
+
+  // if the doctor is chasing the player
+  if (state.doctor.isChasing == true) {
+    // if the player escaped from the room where the
+    // doctor was, the doctor stops chasing and becomes inactive
+    if (state.player.currentRoom != state.doctor.currentRoom) {
+      state.doctor.isChasing = false;
+    }
+
+    // doctor is chasing the player
+    if (state.doctor.chase(state.player, state.now)) {
+      state.events |= eventDoctorMoved;
+    }
+
+    // check if the player was found by the doctor
+    state.checkPlayerWasFoundByDoctor();
+  }
+
+  // if the doctor is inactive, check if
+  // the note was found by the player
+  if (state.doctor.isWaiting == false && state.doctor.isChasing == false) {
+    state.checkPlayerFoundNote();
+  }
+
+  // at every step, check if
+  // the player is winning or losing
+  state.checkPlayerWon();
+  state.checkPlayerLost();
+}
+
+#endif
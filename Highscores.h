@@ -3,113 +3,336 @@
 #define HIGHSCORES_H
 
 #include "ConstantsHighscore.h"
+#include "EepromWriter.h"
+#include "Store.h"
 
-// addressed in EEPROM memory where
-// highscores information is stored
-const byte playerNamesStartAddr = 3;
-const byte highscoreStartAddr = 6;
-const byte highscoresRegisteredAddr = 24;
-// the name of the player is 3 bytes, and the score
-// is 4 bytes, so for a highscore 7 bytes are needed to store it
-const byte highscoreSize = 7;   
-const unsigned int highscoreDefaultValue = 900;
+// where the number of highscores, and the free slot of
+// the table, are stored in the payload of the store
+const byte highscoresRegisteredAddr = 3;
+const byte highscoresFreeAddr = 4;
 
+// the highscores are records of 32 bits:
+// 3 letters of 5 bits (0 for a space, then A to Z),
+// then the escape time, in centiseconds, on 17 bits
+const byte highscoreLetterBits = 5;
+const byte highscoreTimeBits = 17;
+const unsigned long highscoreLongestTime = (1UL << highscoreTimeBits) - 1;
+
+/*
+  The highscores are never moved: every slot of the table but
+  the free one holds a highscore, in no order, while the table
+  is full, or else the slots before the free one do. A new
+  highscore is written to the free slot, out of the table, and
+  only gets in when the store saves the new free slot: the next
+  one, or the slot of the slowest highscore of a full table,
+  which falls off. A write cut by a power loss is then only ever
+  in the free slot, and the writes go around the whole table.
+*/
 // the actual number of highscores that is stored in EPPROM
 byte highscoresRegistered;
+byte highscoresFree;
+// escape time of the last one, in centiseconds, so a game can
+// tell if it made the table without reading the EEPROM
+unsigned long slowestHighscore = highscoreDefaultValue;
+
+int highscoreSlotAddr(byte slot){
+  return highscoresStartAddr + slot * highscoreSize;
+}
+
+bool isHighscoreSlot(byte slot){
+  return slot <= highscoresRegistered && slot != highscoresFree;
+}
+
+uint32_t packHighscore(const char playerName[], unsigned long time){
+  uint32_t record = 0;
+
+  for (byte letter = 0; letter < playerNameSize; letter++) {
+    char character = playerName[letter];
+    byte code = character >= 'A' && character <= 'Z' ? character - 'A' + 1 : 0;
+
+    record = (record << highscoreLetterBits) | code;
+  }
+
+  return (record << highscoreTimeBits) | (time < highscoreLongestTime ? time : highscoreLongestTime);
+}
+
+void unpackHighscore(uint32_t record, char playerName[], unsigned long &time){
+  time = record & highscoreLongestTime;
 
-unsigned long highscores[maximumHighscores];
-char playerNames[maximumHighscores][playerNameSize];
+  for (byte letter = 0; letter < playerNameSize; letter++) {
+    byte shift = highscoreTimeBits + (playerNameSize - 1 - letter) * highscoreLetterBits;
+    byte code = (record >> shift) & ((1 << highscoreLetterBits) - 1);
+
+    playerName[letter] = code == 0 ? ' ' : 'A' + code - 1;
+  }
+}
 
 /*
-  Load the number of highscores, the highscores and
-  their associated player name from EEPROM.
+  Read the highscore in the slot of the table, stored lowest
+  byte first. Only with the EEPROM writer idle, as the EEPROM
+  interrupt uses the same registers.
 */
-void loadPlayersHighschores(){
-  // read the number of highscores registered
-  EEPROM.get(highscoresRegisteredAddr, highscoresRegistered);
+uint32_t readHighscoreSlot(byte slot){
+  uint32_t record = 0;
+
+  for (byte i = 0; i < highscoreSize; i++) {
+    record |= (uint32_t) EEPROM.read(highscoreSlotAddr(slot) + i) << (8 * i);
+  }
+
+  return record;
+}
+
+unsigned long readHighscoreSlotTime(byte slot){
+  return readHighscoreSlot(slot) & highscoreLongestTime;
+}
+
+/*
+  Returns true if the highscore in the slot comes before
+  the other one: it is faster, or as fast in a lower slot,
+  so equal times are listed by slot, not by age.
+*/
+bool isBefore(unsigned long time, byte slot, unsigned long otherTime, byte other){
+  return time < otherTime || (time == otherTime && slot < other);
+}
 
-  for (int score = 0; score < maximumHighscores; score++) {
-    // read the ith score and the player's name who 
-    // made that score
-    char playerName[3];
+/*
+  The index of the highscore in the slot, fastest first:
+  how many highscores come before it.
+*/
+byte highscoreIndex(byte slot){
+  unsigned long time = readHighscoreSlotTime(slot);
+  byte before = 0;
 
-    // player names are made of 3 characters
-    for (int letter = 0; letter < 3; letter++) {
-      EEPROM.get(playerNamesStartAddr + score * highscoreSize + letter, playerNames[score][letter]);
+  for (byte other = 0; other < highscoreSlots; other++) {
+    if (other != slot && isHighscoreSlot(other)
+        && isBefore(readHighscoreSlotTime(other), other, time, slot)) {
+      before += 1;
     }
-    
-    EEPROM.get(highscoreStartAddr + score * highscoreSize, highscores[score]);
-  }  
-};
+  }
+
+  return before;
+}
 
 /*
-  Given a new highscores and its associated player name, insert
-  the score into the list of highscores.
+  Slot of the slowest highscore but the one in the skipped
+  slot, or highscoreSlots without any.
+*/
+byte slowestHighscoreSlot(byte skipped){
+  byte slowest = highscoreSlots;
+  unsigned long slowestTime = 0;
+
+  for (byte slot = 0; slot < highscoreSlots; slot++) {
+    if (slot == skipped || !isHighscoreSlot(slot)) {
+      continue;
+    }
+
+    unsigned long time = readHighscoreSlotTime(slot);
+    if (slowest == highscoreSlots || isBefore(slowestTime, slowest, time, slot)) {
+      slowest = slot;
+      slowestTime = time;
+    }
+  }
 
-  Update the rest of the highscores as well (if possible), by
-  copying them to a lower rank in the list.
+  return slowest;
+}
+
+/*
+  The highscore at the index, fastest first. It reads the
+  whole table for every highscore, about 10 ms on the board,
+  so it is only used for the few a page shows.
 */
-void updateHighscores(unsigned long newHighscore, char playerName[]){
-  for (int i = 0; i < highscoresRegistered; i++) {
-    // search for the position where the new highscores
-    // should ne inserted
-    if (newHighscore < highscores[i]) {
-      // copy all the values from the position where the new score
-      // will be inserted into lower positions, to keep the top valid
-      for (int j = highscoresRegistered - 1; j >= i + 1; j--) {
-        highscores[j] = highscores[j - 1]; 
-        playerNames[i][j] = playerNames[i][j - 1];
-      }
-
-      // insert the new highscore
-      highscores[i] = newHighscore;
-
-      for (int j = 0; j < 3; j++) {
-        playerNames[i][j] = playerName[j];
-      }
-      break;
+uint32_t readHighscore(byte index){
+  for (byte slot = 0; slot < highscoreSlots; slot++) {
+    if (isHighscoreSlot(slot) && highscoreIndex(slot) == index) {
+      return readHighscoreSlot(slot);
     }
   }
+
+  return packHighscore("   ", highscoreDefaultValue);
+}
+
+unsigned long readHighscoreTime(byte index){
+  return readHighscore(index) & highscoreLongestTime;
+}
+
+/*
+  Load the number of highscores and the free slot from the
+  store, and the time of the slowest one; the highscores
+  stay in EEPROM.
+*/
+void loadPlayersHighschores(){
+  // read the number of highscores registered
+  store.get(highscoresRegisteredAddr, highscoresRegistered);
+  store.get(highscoresFreeAddr, highscoresFree);
+
+  if (highscoresRegistered > maximumHighscores || highscoresFree >= highscoreSlots
+      || (highscoresRegistered < maximumHighscores && highscoresFree != highscoresRegistered)) {
+    highscoresRegistered = 0;
+    highscoresFree = 0;
+  }
+
+  slowestHighscore = highscoreDefaultValue;
+  if (highscoresRegistered > 0) {
+    eepromWriter.flush();
+    slowestHighscore = readHighscoreSlotTime(slowestHighscoreSlot(highscoreSlots));
+  }
 };
 
 /*
-  Write the number of highscores, the highscores and
-  their associated player name into EEPROM.
+  Returns true if an escape in the time makes the table: while
+  it is not full, or faster than the slowest highscore, which
+  falls off then. The game asks it before showing the new
+  highscore, and the table before putting it in.
+*/
+bool isHighscore(unsigned long time){
+  return highscoresRegistered < maximumHighscores || time < slowestHighscore;
+}
+
+/*
+  Places shown in the highscores menu: the
+  registered ones, or a single empty one.
+*/
+byte highscoresShown(){
+  return highscoresRegistered > 0 ? highscoresRegistered : 1;
+}
+
+/*
+  The highscores on the LCD, read from EEPROM when
+  the list is scrolled, instead of the whole table.
+*/
+struct HighscoresPage{
+  // index of the first highscore of the page
+  byte first;
+  bool isLoaded;
+  char playerNames[2][playerNameSize];
+  unsigned long scores[2];
+
+  HighscoresPage(): first(0), isLoaded(false) {}
+
+  bool load(byte first);
+};
+
+HighscoresPage highscoresPage;
 
-  This function will be called whenever the highscores
-  will be updated, in order for the EEPROM memory to keep up
-  with the changes.
+/*
+  A game that made the table: it waits for the EEPROM writer to
+  be idle, so the table can be read, then is written to the free
+  slot, and the store saves the new free slot once it is there.
 */
-void writeHighscores(){
-  EEPROM.put(highscoresRegisteredAddr, highscoresRegistered);
+struct HighscoresWriting{
+  bool isPending;
+  uint32_t record;
+  // the record, as it is written
+  byte bytes[highscoreSize];
+  EepromRequest recordRequest;
+
+  HighscoresWriting(): isPending(false), record(0) {}
+
+  void update();
+};
 
-  for (int i = 0; i < highscoresRegistered; i++) {
-    EEPROM.put(highscoreStartAddr + i * highscoreSize, highscores[i]);
+HighscoresWriting highscoresWriting;
+
+void HighscoresWriting::update(){
+  if (!isPending || !eepromWriter.isIdle() || eepromWriter.freeSpace() < 2) {
+    return;
+  }
+
+  isPending = false;
+  highscoresPage.isLoaded = false;
+
+  unsigned long time = record & highscoreLongestTime;
+  if (!isHighscore(time)) {
+    return;
+  }
 
-    for (int letter = 0; letter < 3; letter++) {
-      EEPROM.put(playerNamesStartAddr + i * highscoreSize + letter, playerNames[i][letter]);
+  // the table is read before the highscore is queued
+  byte slot = highscoresFree;
+  if (highscoresRegistered < maximumHighscores) {
+    if (highscoresRegistered == 0 || time > slowestHighscore) {
+      slowestHighscore = time;
     }
+    highscoresRegistered += 1;
+    highscoresFree = highscoresRegistered;
+  } else {
+    // the slowest falls off, its slot is the free one now
+    byte fallen = slowestHighscoreSlot(highscoreSlots);
+    unsigned long nextTime = readHighscoreSlotTime(slowestHighscoreSlot(fallen));
+    slowestHighscore = time > nextTime ? time : nextTime;
+    highscoresFree = fallen;
   }
+
+  for (byte i = 0; i < highscoreSize; i++) {
+    bytes[i] = record >> (8 * i);
+  }
+  eepromWriter.write(recordRequest, highscoreSlotAddr(slot), bytes, highscoreSize);
+
+  // saved after the highscore, so it never counts one not written yet
+  store.put(highscoresRegisteredAddr, highscoresRegistered);
+  store.put(highscoresFreeAddr, highscoresFree);
+  store.save();
+}
+
+/*
+  Given a new highscore and its associated player name, insert
+  it into the table of highscores, in EEPROM, in the background.
+*/
+void updateHighscores(unsigned long newHighscore, const char playerName[]){
+  highscoresWriting.record = packHighscore(playerName, newHighscore);
+  highscoresWriting.isPending = true;
+  highscoresWriting.update();
 };
 
 /*
-  Reset the highscores, seting the scores to a high
-  value (15:00 minutes, 900 seconds). 
-  
-  Also, the number of highscores registered will become 0. 
+  Reset the highscores: the number of highscores registered
+  will become 0, the old records are left in EEPROM.
 */
 void resetHighscores(){
-  for (int i = 0; i < maximumHighscores; i++) {
-    highscores[i] = highscoreDefaultValue;
+  highscoresWriting.isPending = false;
+  highscoresPage.isLoaded = false;
 
-    for (int letter = 0; letter < 3; letter++) {
-      playerNames[i][letter] = ' ';
+  highscoresRegistered = 0;
+  highscoresFree = 0;
+  slowestHighscore = highscoreDefaultValue;
+
+  store.put(highscoresRegisteredAddr, highscoresRegistered);
+  store.put(highscoresFreeAddr, highscoresFree);
+  store.save();
+};
+
+/*
+  Read the two highscores from the first one on, unless they
+  are read already. Returns false while the EEPROM is written,
+  the page is read once it is done; the places after the
+  registered highscores are empty. Both are found in a single
+  pass over the table, from the index of every highscore.
+*/
+bool HighscoresPage::load(byte first){
+  if (isLoaded && this->first == first) {
+    return true;
+  }
+
+  if (highscoresWriting.isPending || !eepromWriter.isIdle()) {
+    return false;
+  }
+
+  scores[0] = highscoreDefaultValue;
+  scores[1] = highscoreDefaultValue;
+
+  for (byte slot = 0; slot < highscoreSlots; slot++) {
+    if (!isHighscoreSlot(slot)) {
+      continue;
+    }
+
+    byte index = highscoreIndex(slot);
+    if (index >= first && index < first + 2) {
+      unpackHighscore(readHighscoreSlot(slot), playerNames[index - first], scores[index - first]);
     }
   }
 
-  highscoresRegistered = 3;
-  writeHighscores();
-  highscoresRegistered = 0;
-};
+  this->first = first;
+  isLoaded = true;
+  return true;
+}
 
-#endif
\ No newline at end of file
+#endif
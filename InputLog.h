@@ -0,0 +1,162 @@
+#pragma once
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include "Platform.h"
+#include "Directions.h"
+
+/*
+  Binary format of a recorded run, small enough
+  to be streamed over the serial port while playing:
+
+  -> header: 'S' 'E' 'I', the version, then the seed of
+     the board's random generator (4 bytes, lowest first)
+  -> one record for each loop with some input: the ms since
+     the previous record as a varint (7 bits per byte, lowest
+     first, the high bit set on all but the last byte),
+     then the event byte
+
+  The event byte holds the direction in its low 3 bits
+  (inputEventNoDirection for none) and the switch press in bit 3.
+*/
+const byte inputLogMagic[3] = {'S', 'E', 'I'};
+const byte inputLogVersion = 1;
+const byte inputLogHeaderSize = 8;
+// a record is at most a 5 byte varint and the event
+const byte inputLogRecordMaximumSize = 6;
+
+const byte inputEventDirectionMask = 7;
+const byte inputEventNoDirection = 7;
+const byte inputEventPressed = 8;
+
+byte encodeInputEvent(byte direction, bool isPressed){
+  byte event = direction < directions ? direction : inputEventNoDirection;
+
+  if (isPressed) {
+    event |= inputEventPressed;
+  }
+  return event;
+}
+
+void decodeInputEvent(byte event, byte &direction, bool &isPressed){
+  direction = event & inputEventDirectionMask;
+  if (direction == inputEventNoDirection) {
+    direction = joystickNone;
+  }
+
+  isPressed = (event & inputEventPressed) != 0;
+}
+
+/*
+  Encodes the header and the records, remembering
+  the time of the last record for the deltas.
+*/
+struct InputLogWriter{
+  unsigned long lastTime;
+
+  InputLogWriter(): lastTime(0) {}
+
+  byte header(uint32_t seed, byte bytes[]);
+  byte record(unsigned long time, byte event, byte bytes[]);
+};
+
+byte InputLogWriter::header(uint32_t seed, byte bytes[]){
+  bytes[0] = inputLogMagic[0];
+  bytes[1] = inputLogMagic[1];
+  bytes[2] = inputLogMagic[2];
+  bytes[3] = inputLogVersion;
+
+  for (byte i = 0; i < 4; i++) {
+    bytes[4 + i] = (seed >> (8 * i)) & 0xFF;
+  }
+
+  lastTime = 0;
+  return inputLogHeaderSize;
+}
+
+byte InputLogWriter::record(unsigned long time, byte event, byte bytes[]){
+  unsigned long delta = time - lastTime;
+  lastTime = time;
+
+  byte size = 0;
+  while (delta >= 0x80) {
+    bytes[size++] = (delta & 0x7F) | 0x80;
+    delta >>= 7;
+  }
+  bytes[size++] = delta;
+  bytes[size++] = event;
+
+  return size;
+}
+
+/*
+  Decodes a recorded run from memory. Anything before the
+  header, like text printed on the serial port, is skipped.
+*/
+struct InputLogReader{
+  const byte *bytes;
+  unsigned long size;
+  unsigned long position;
+  unsigned long time;
+  uint32_t seed;
+
+  InputLogReader(const byte *bytes, unsigned long size): bytes(bytes), size(size), position(0), time(0), seed(0) {}
+
+  bool begin();
+  bool next(unsigned long &recordTime, byte &event);
+};
+
+/*
+  Find and read the header. Returns false if there is none.
+*/
+bool InputLogReader::begin(){
+  for (position = 0; position + inputLogHeaderSize <= size; position++) {
+    if (bytes[position] == inputLogMagic[0] && bytes[position + 1] == inputLogMagic[1]
+        && bytes[position + 2] == inputLogMagic[2] && bytes[position + 3] == inputLogVersion) {
+      seed = 0;
+      for (byte i = 0; i < 4; i++) {
+        seed |= (uint32_t) bytes[position + 4 + i] << (8 * i);
+      }
+
+      position += inputLogHeaderSize;
+      time = 0;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*
+  Read the next record. Returns false at the end of the
+  run, or if the last record was cut short.
+*/
+bool InputLogReader::next(unsigned long &recordTime, byte &event){
+  unsigned long delta = 0;
+  byte shift = 0;
+
+  while (true) {
+    if (position >= size || shift > 28) {
+      return false;
+    }
+
+    byte value = bytes[position++];
+    delta |= (unsigned long) (value & 0x7F) << shift;
+    shift += 7;
+
+    if ((value & 0x80) == 0) {
+      break;
+    }
+  }
+
+  if (position >= size) {
+    return false;
+  }
+
+  event = bytes[position++];
+  time += delta;
+  recordTime = time;
+  return true;
+}
+
+#endif
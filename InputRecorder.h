@@ -0,0 +1,46 @@
+#pragma once
+#ifndef INPUT_RECORDER_H
+#define INPUT_RECORDER_H
+
+#include "InputLog.h"
+#include "JoyStick.h"
+#include "Scheduler.h"
+
+// stream every input over the serial port, so the run can
+// be replayed on the host with tools/Replay.cpp; the serial
+// monitor only shows garbage meanwhile
+const bool isRecordingInput = false;
+
+InputLogWriter inputLogWriter;
+
+/*
+  Start the recording with the seed the board's
+  random generator was seeded with.
+*/
+void startInputRecording(uint32_t seed){
+  if (!isRecordingInput) {
+    return;
+  }
+
+  byte bytes[inputLogHeaderSize];
+  Serial.write(bytes, inputLogWriter.header(seed, bytes));
+};
+
+/*
+  Record the joystick's input of this loop, if there is any.
+*/
+void recordInput(const Joystick &joystick){
+  if (!isRecordingInput) {
+    return;
+  }
+
+  if (joystick.direction == joystickNone && joystick.currentSwitchStateChanged == LOW) {
+    return;
+  }
+
+  byte bytes[inputLogRecordMaximumSize];
+  byte event = encodeInputEvent(joystick.direction, joystick.currentSwitchStateChanged == HIGH);
+  Serial.write(bytes, inputLogWriter.record(tickNow, event, bytes));
+};
+
+#endif
@@ -0,0 +1,116 @@
+#pragma once
+#ifndef JOB_H
+#define JOB_H
+
+#include "Platform.h"
+#include "Log.h"
+
+// what one unit of a job's work reports back
+// the job has more work, the slice can go on
+const byte jobWorking = 0;
+// the job has more work, but has to wait for the
+// hardware, so the rest of the slice is given up
+const byte jobWaiting = 1;
+// the job is finished
+const byte jobDone = 2;
+
+/*
+  Work too long for a single tick, like drawing a whole room
+  or writing the highscores in EEPROM, done a slice at a time.
+  Every slice repeats small units of the work (a row, a byte)
+  until the job is done or its budget of µs is spent, so the
+  ticks stay short and the input and the melody keep up.
+
+  A job is any struct with a Job member named job and a
+  byte advance() function, doing one unit of the work.
+*/
+struct Job{
+  const char *name;
+  // time a slice can take, in µs; the unit that
+  // crosses it is finished before the slice stops
+  unsigned int budget;
+  bool isRunning;
+
+  // runs of the job that were finished
+  unsigned long runs;
+  // slices of the current run
+  unsigned int slices;
+  // slices of the last finished run, and of the longest one
+  unsigned int lastSlices;
+  unsigned int mostSlices;
+  // longest slice, in µs
+  unsigned long longestSlice;
+
+  Job(const char *name, unsigned int budget):
+    name(name), budget(budget), isRunning(false),
+    runs(0), slices(0), lastSlices(0), mostSlices(0), longestSlice(0) {}
+
+  void start();
+  void cancel();
+  void finish();
+  void printStatistics();
+};
+
+/*
+  Start a new run, leaving the current one behind.
+*/
+void Job::start(){
+  isRunning = true;
+  slices = 0;
+}
+
+void Job::cancel(){
+  isRunning = false;
+}
+
+void Job::finish(){
+  isRunning = false;
+  runs += 1;
+
+  lastSlices = slices;
+  if (slices > mostSlices) {
+    mostSlices = slices;
+  }
+}
+
+/*
+  Run one slice of the job, if it is running.
+  Returns true once the job is done.
+*/
+template <class Work>
+bool runSlice(Work &work){
+  Job &job = work.job;
+
+  if (!job.isRunning) {
+    return false;
+  }
+
+  unsigned long start = micros();
+  byte status;
+
+  do {
+    status = work.advance();
+  } while (status == jobWorking && micros() - start < job.budget);
+
+  unsigned long duration = micros() - start;
+  if (duration > job.longestSlice) {
+    job.longestSlice = duration;
+  }
+  job.slices += 1;
+
+  if (status == jobDone) {
+    job.finish();
+    return true;
+  }
+
+  return false;
+}
+
+/*
+  Log the runs, the slices they took and the longest slice.
+*/
+void Job::printStatistics(){
+  LOG_INFO(logJobStatistics, name, runs, lastSlices, mostSlices, longestSlice);
+}
+
+#endif
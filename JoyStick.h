@@ -2,99 +2,269 @@
 #ifndef JOYSTICK_H
 #define JOYSTICK_H
 
-/* each direction of the joystick will have a
-column in the matrix associated*/
-const byte joystickUp = 0;
-const byte joystickDown = 1;
-const byte joystickLeft = 2;
-const byte joystickRight = 3;
-
-/* joystick bounds that will identify in which
-direction is the user pointing at: up, down, left, right */
-const int joystickUpBound = 768;                    // 512 + 256
-const int joystickDownBound = 256;                  // 512 - 256
-const int joystickRightBound = 768;                 // 512 + 256
-const int joystickLeftBound = 256;                  // 512 - 256
-const int joystickMiddleInterval[2] = {492, 532};   // 512 - 20, 512 + 20
-
-const byte joystickLastDirectionInterval = 500;
+#include "Directions.h"
+#include "EventQueue.h"
+#include "AxisSampler.h"
+#include "ConstantsJoystick.h"
+#include "JoystickCalibration.h"
+
+/* the joystick points in a direction when it leaves the
+deadzone, an ellipse around the calibrated middle; the axis
+pushed the most decides: up, down, left, right. The offsets
+are scaled so the edge of the deadzone is at joystickDeadzoneScale */
+const long joystickDeadzoneScale = 64;
+// the other axis needs to be pushed this much more to take
+// over the held direction, so diagonals do not jitter
+const long joystickDiagonalHysteresis = 16;
+// how far past the deadzone the stick is, from 0 to this
+const int joystickDeflectionScale = 256;
+
 const byte joystickSwitchDebounceInterval = 100;
 
+// a direction the joystick was pointed at, and when
+struct DirectionEvent{
+  unsigned long time;
+  byte direction;
+};
+
+const byte directionEventsCapacity = 4;
+
+// a press or a release of the switch, as seen by the interrupt
+struct ButtonEvent{
+  unsigned long time;
+  bool isPressed;
+};
+
+const byte buttonEventsCapacity = 8;
+EventQueue<ButtonEvent, buttonEventsCapacity> buttonEvents;
+
+// pin read by the interrupt, set by Joystick::begin()
+byte buttonPin;
+// state reported by the last event, and when it was reported
+volatile bool buttonReportedState = LOW;
+volatile unsigned long buttonReportedTime = 0;
+
+/*
+  Called on every edge of the switch. The first edge is reported
+  right away, with its time; the edges that follow within the
+  debounce interval are the contacts bouncing, so they are ignored.
+*/
+void buttonInterrupt(){
+  unsigned long now = millis();
+  bool switchState = !digitalRead(buttonPin);
+
+  if (switchState == buttonReportedState || (now - buttonReportedTime) < joystickSwitchDebounceInterval) {
+    return;
+  }
+
+  buttonReportedState = switchState;
+  buttonReportedTime = now;
+
+  ButtonEvent event = {now, switchState};
+  buttonEvents.push(event);
+}
+
 struct Joystick {
   byte pinSW;
   byte pinX;
   byte pinY;
 
+  // direction of the event handled in this loop, or joystickNone
   byte direction;
   int axisValueX, axisValueY;
+  JoystickCalibration calibration;
+
+  EventQueue<DirectionEvent, directionEventsCapacity> directionEvents;
+  // direction the stick is held in, and when it repeats next
+  byte heldDirection;
+  unsigned long nextRepeatTime;
+  int repeatInterval;
   
   bool currentSwitchState;
   bool currentSwitchStateChanged; 
-  bool lastSwitchState; 
 
-  unsigned long int switchDebounceTime;
-  unsigned long int lastDirectionChange;
+  // time of the last press, taken by the interrupt
+  unsigned long int switchPressTime;
 
   Joystick(byte pinSW, byte pinX, byte pinY): pinSW(pinSW), pinX(pinX), pinY(pinY){
+    this->direction = joystickNone;
+
     this->currentSwitchState = LOW;
     this->currentSwitchStateChanged = LOW;
-    this->lastSwitchState = LOW; 
      
-    this->switchDebounceTime = 0;
-    this->lastDirectionChange = 0;
+    this->switchPressTime = 0;
+
+    this->heldDirection = joystickNone;
+    this->nextRepeatTime = 0;
+    this->repeatInterval = joystickRepeatInterval;
   } 
 
+  void begin();
   void switchHandler();
   void movementHandler();
+  void directionWatcher(unsigned long currentTime);
+  int deflection(byte direction);
+  bool isTouched();
 };
 
+/*
+  Listen to the switch through the INT0 interrupt, so a press
+  is not missed while the loop is busy with the LCD or EEPROM,
+  and start sampling the axes in the background.
+*/
+void Joystick::begin(){
+  buttonPin = pinSW;
+  attachInterrupt(digitalPinToInterrupt(pinSW), buttonInterrupt, CHANGE);
+
+  // keep the ideal values until the joystick is calibrated
+  if (!loadCalibration(calibration)) {
+    calibration.reset();
+  }
+
+  startAxisSampler(pinX, pinY);
+}
+
+/*
+  Take the presses and releases queued by the interrupt. Only
+  one press is handled per loop, the others wait in the queue
+  for the next loops.
+*/
 void Joystick::switchHandler(){
-  bool switchState = !digitalRead(pinSW);
   currentSwitchStateChanged = LOW;
 
-  if (switchState != lastSwitchState) {
-    // if the state has changed, update the last debounce time of the button
-    switchDebounceTime = millis();
-  } 
+  // if the contacts were still bouncing when the debounce
+  // interval ended, the last edge was ignored; report the
+  // state the switch settled in
+  noInterrupts();
+  buttonInterrupt();
+  interrupts();
 
-  if ((millis() - switchDebounceTime) > joystickSwitchDebounceInterval) {
-    /* because it passed a certain debounce time, it means that the reading state
-    is not a noise, so the current state of the button must be changed*/
-    if (currentSwitchState != switchState) {
-      currentSwitchState = switchState;    
+  ButtonEvent event;
+  while (buttonEvents.pop(event)) {
+    currentSwitchState = event.isPressed;
 
-      if (currentSwitchState == HIGH) {
-        currentSwitchStateChanged = HIGH;
-      }
+    if (event.isPressed) {
+      currentSwitchStateChanged = HIGH;
+      switchPressTime = event.time;
+      break;
     }
-  } 
-
-  lastSwitchState = switchState;
+  }
 }
 
+/*
+  Take the oldest direction event, queued by directionWatcher(),
+  as the direction of this loop. The events are queued, so a
+  quick flick is never lost, even if it happens while the loop
+  was busy; one is handled per loop.
+*/
 void Joystick::movementHandler(){
-  if ((millis() - lastDirectionChange) <= joystickLastDirectionInterval) {
-    /*if the minimum interval of time betweens joystick direction changes
-    has not passed, do not evaluate the joystick's state*/
-    direction = -1;
-    return ;
+  DirectionEvent event;
+  if (directionEvents.pop(event)) {
+    direction = event.direction;
+  } else {
+    direction = joystickNone;
+  }
+};
+
+/*
+  Raise an event when the stick crosses into a direction, then
+  keep repeating it while the stick is held there: first after
+  joystickRepeatDelay, then faster and faster, and faster
+  the further the stick is pushed.
+*/
+void Joystick::directionWatcher(unsigned long currentTime){
+  // the latest averages, without waiting for the ADC
+  readAxes(axisValueX, axisValueY);
+
+  // offsets from the middle, scaled by the deadzone of their axis
+  long scaledX = (long) (axisValueX - calibration.centerX) * joystickDeadzoneScale / calibration.deadzoneX;
+  long scaledY = (long) (axisValueY - calibration.centerY) * joystickDeadzoneScale / calibration.deadzoneY;
+
+  byte currentDirection = joystickNone;
+
+  // check in which direction is the joystick pointing at,
+  // once it left the deadzone
+  if (scaledX * scaledX + scaledY * scaledY > joystickDeadzoneScale * joystickDeadzoneScale) {
+    long distanceX = scaledX < 0 ? -scaledX : scaledX;
+    long distanceY = scaledY < 0 ? -scaledY : scaledY;
+
+    // favour the axis that is already held
+    if (heldDirection == joystickUp || heldDirection == joystickDown) {
+      distanceX += joystickDiagonalHysteresis;
+    } else if (heldDirection == joystickLeft || heldDirection == joystickRight) {
+      distanceY += joystickDiagonalHysteresis;
+    }
+
+    if (distanceX >= distanceY) {
+      currentDirection = scaledX > 0 ? joystickUp : joystickDown;
+    } else {
+      currentDirection = scaledY > 0 ? joystickRight : joystickLeft;
+    }
+  }
+
+  if (currentDirection == joystickNone) {
+    heldDirection = joystickNone;
+    return;
   }
 
-  lastDirectionChange = millis();
+  DirectionEvent event = {currentTime, currentDirection};
 
-  axisValueX = analogRead(pinX);
-  axisValueY = analogRead(pinY);
+  // the stick has just been pushed in a new direction
+  if (currentDirection != heldDirection) {
+    heldDirection = currentDirection;
+    repeatInterval = joystickRepeatInterval;
+    nextRepeatTime = currentTime + joystickRepeatDelay;
 
-  // check in which direction is the joystick pointing at
-  if (axisValueX > joystickUpBound && joystickMiddleInterval[0] < axisValueY < joystickMiddleInterval[1]) {
-    direction = joystickUp;        // joystick is pointing up
-  } else if (axisValueY > joystickRightBound && joystickMiddleInterval[0] < axisValueX < joystickMiddleInterval[1]) {
-    direction = joystickRight;     // joystick is pointing right
-  } else if (axisValueX < joystickDownBound && joystickMiddleInterval[0] < axisValueY < joystickMiddleInterval[1]) {
-    direction = joystickDown;      // joystick is pointing down
-  } else if (axisValueY < joystickLeftBound && joystickMiddleInterval[0] < axisValueX < joystickMiddleInterval[1]) {
-    direction = joystickLeft;      // joystick is pointing left 
+    directionEvents.push(event);
+    return;
   }
-};
 
-#endif
\ No newline at end of file
+  if ((long) (currentTime - nextRepeatTime) < 0) {
+    return;
+  }
+
+  directionEvents.push(event);
+
+  // push slightly past the deadzone: twice the interval,
+  // all the way: the interval itself
+  long interval = (long) repeatInterval * (2 * joystickDeflectionScale - deflection(currentDirection))
+                  / joystickDeflectionScale;
+  nextRepeatTime = currentTime + interval;
+
+  if (repeatInterval - joystickRepeatAcceleration >= joystickRepeatFastestInterval) {
+    repeatInterval -= joystickRepeatAcceleration;
+  }
+}
+
+/*
+  How far past the deadzone the stick is pushed in the
+  given direction, from 0 to joystickDeflectionScale.
+*/
+int Joystick::deflection(byte direction){
+  bool isAxisX = direction == joystickUp || direction == joystickDown;
+  int distance = isAxisX ? axisValueX - calibration.centerX : axisValueY - calibration.centerY;
+  int deadzone = isAxisX ? calibration.deadzoneX : calibration.deadzoneY;
+  int range = isAxisX ? calibration.rangeX : calibration.rangeY;
+
+  if (distance < 0) {
+    distance = -distance;
+  }
+
+  if (distance <= deadzone) {
+    return 0;
+  }
+  if (distance >= range) {
+    return joystickDeflectionScale;
+  }
+
+  return (long) (distance - deadzone) * joystickDeflectionScale / (range - deadzone);
+}
+
+/*
+  Returns true if the joystick was moved or pressed in this loop.
+*/
+bool Joystick::isTouched(){
+  return direction != joystickNone || currentSwitchStateChanged == HIGH;
+}
+
+#endif
@@ -0,0 +1,243 @@
+#pragma once
+#ifndef JOYSTICK_CALIBRATION_H
+#define JOYSTICK_CALIBRATION_H
+
+#include <string.h>
+
+#include "EEPROM.h"
+
+#include "ConstantsHighscore.h"
+#include "Crc8.h"
+#include "EepromWriter.h"
+
+// address in EEPROM memory where the calibration is stored
+const byte calibrationStartAddr = 48;
+// first byte of a valid calibration, changed whenever the layout changes
+const byte calibrationVersion = 1;
+// the version, the 6 values on 2 bytes each, lowest first, then the
+// CRC-8 of the values; the same size on the board and on the host
+const byte calibrationValues = 6;
+const byte calibrationRecordSize = 1 + 2 * calibrationValues + 1;
+
+static_assert(calibrationStartAddr + calibrationRecordSize <= highscoresStartAddr,
+              "the calibration runs into the highscores");
+
+// part of an axis' range, in percents, the deadzone takes
+const byte calibrationDeadzonePercent = 50;
+// the deadzone stays this far above the noise of the middle
+const int calibrationNoiseMargin = 16;
+// time the middle is sampled for, in ms
+const int calibrationCenterInterval = 1000;
+// an axis' shorter side has to be pushed at least this far from
+// the middle, or the stick was not moved to its edges
+const int calibrationMinimumRange = 128;
+
+/*
+  Where the middle of each axis is, how far the stick needs
+  to be pushed before it points in a direction (the deadzone)
+  and how far it can be pushed at all (the range).
+*/
+struct JoystickCalibration{
+  int centerX;
+  int centerY;
+  int deadzoneX;
+  int deadzoneY;
+  int rangeX;
+  int rangeY;
+
+  JoystickCalibration(){
+    reset();
+  }
+
+  void reset();
+  bool isValid() const;
+};
+
+/*
+  Values of an ideal joystick, used until it is calibrated.
+*/
+void JoystickCalibration::reset(){
+  centerX = 512;
+  centerY = 512;
+  deadzoneX = 256;
+  deadzoneY = 256;
+  rangeX = 511;
+  rangeY = 511;
+};
+
+/*
+  Returns true if the values can be used: the middle on the
+  ADC's scale, and a deadzone inside a range long enough.
+*/
+bool JoystickCalibration::isValid() const{
+  return centerX >= 0 && centerX <= 1023 && centerY >= 0 && centerY <= 1023
+      && deadzoneX > 0 && deadzoneY > 0
+      && rangeX >= calibrationMinimumRange && rangeY >= calibrationMinimumRange
+      && rangeX > deadzoneX && rangeY > deadzoneY;
+}
+
+/*
+  Smallest, biggest and average value of the axes
+  during one step of the calibration.
+*/
+struct CalibrationSampler{
+  long sumX, sumY;
+  unsigned int samples;
+  int minimumX, maximumX;
+  int minimumY, maximumY;
+
+  void reset();
+  void add(int x, int y);
+};
+
+void CalibrationSampler::reset(){
+  sumX = 0;
+  sumY = 0;
+  samples = 0;
+  minimumX = 1023;
+  maximumX = 0;
+  minimumY = 1023;
+  maximumY = 0;
+};
+
+void CalibrationSampler::add(int x, int y){
+  sumX += x;
+  sumY += y;
+  samples += 1;
+
+  if (x < minimumX) minimumX = x;
+  if (x > maximumX) maximumX = x;
+  if (y < minimumY) minimumY = y;
+  if (y > maximumY) maximumY = y;
+};
+
+/*
+  The deadzone of an axis is a part of its range, but always
+  above the noise measured while the stick was in the middle.
+  The range is the shorter side, so the full push can be
+  reached in both directions. Returns false if the range is
+  too short: the stick was not moved to the edges.
+*/
+bool calibrateAxis(long sum, unsigned int samples, int noise, int minimum, int maximum,
+                   int &center, int &deadzone, int &range){
+  center = samples > 0 ? sum / samples : 512;
+
+  range = maximum - center;
+  if (center - minimum < range) {
+    range = center - minimum;
+  }
+
+  if (range < calibrationMinimumRange) {
+    return false;
+  }
+
+  deadzone = (long) range * calibrationDeadzonePercent / 100;
+  if (deadzone < noise + calibrationNoiseMargin) {
+    deadzone = noise + calibrationNoiseMargin;
+  }
+
+  // a range shorter than the deadzone would never point anywhere
+  if (range <= deadzone) {
+    range = deadzone + 1;
+  }
+
+  return true;
+};
+
+/*
+  Work the calibration out from the samples of the middle and of
+  the edges. Returns false, and leaves the calibration as it is,
+  if an axis was not moved far enough.
+*/
+bool finishCalibration(const CalibrationSampler &center, const CalibrationSampler &extremes,
+                       JoystickCalibration &calibration){
+  JoystickCalibration measured;
+
+  if (!calibrateAxis(center.sumX, center.samples, center.maximumX - center.minimumX,
+                     extremes.minimumX, extremes.maximumX,
+                     measured.centerX, measured.deadzoneX, measured.rangeX)) {
+    return false;
+  }
+  if (!calibrateAxis(center.sumY, center.samples, center.maximumY - center.minimumY,
+                     extremes.minimumY, extremes.maximumY,
+                     measured.centerY, measured.deadzoneY, measured.rangeY)) {
+    return false;
+  }
+
+  calibration = measured;
+  return true;
+};
+
+/*
+  The values of the calibration, in the order they are stored.
+*/
+int *calibrationValue(JoystickCalibration &calibration, byte index){
+  int *values[calibrationValues] = {
+    &calibration.centerX, &calibration.centerY,
+    &calibration.deadzoneX, &calibration.deadzoneY,
+    &calibration.rangeX, &calibration.rangeY,
+  };
+
+  return values[index];
+}
+
+/*
+  Load the calibration from EEPROM. Returns false, and keeps
+  the given values, if none was stored or it is corrupted.
+*/
+bool loadCalibration(JoystickCalibration &calibration){
+  eepromWriter.flush();
+
+  byte bytes[calibrationRecordSize];
+  for (byte i = 0; i < calibrationRecordSize; i++) {
+    bytes[i] = EEPROM.read(calibrationStartAddr + i);
+  }
+
+  if (bytes[0] != calibrationVersion || bytes[calibrationRecordSize - 1] != crc8(bytes + 1, 2 * calibrationValues)) {
+    return false;
+  }
+
+  JoystickCalibration stored;
+  for (byte i = 0; i < calibrationValues; i++) {
+    *calibrationValue(stored, i) = (int16_t) (bytes[1 + 2 * i] | (bytes[2 + 2 * i] << 8));
+  }
+
+  if (!stored.isValid()) {
+    return false;
+  }
+
+  calibration = stored;
+  return true;
+};
+
+// the calibration as it is written, with its version and CRC
+byte calibrationBytes[calibrationRecordSize];
+EepromRequest calibrationRequest;
+
+/*
+  Write the calibration into EEPROM, with its version and CRC,
+  in the background. A calibration still being written is
+  finished first, as its bytes cannot change until then.
+*/
+void writeCalibration(const JoystickCalibration &calibration){
+  while (!calibrationRequest.isDone) {
+    eepromWriter.update();
+  }
+
+  JoystickCalibration written = calibration;
+
+  calibrationBytes[0] = calibrationVersion;
+  for (byte i = 0; i < calibrationValues; i++) {
+    int value = *calibrationValue(written, i);
+    calibrationBytes[1 + 2 * i] = value;
+    calibrationBytes[2 + 2 * i] = value >> 8;
+  }
+  calibrationBytes[calibrationRecordSize - 1] = crc8(calibrationBytes + 1, 2 * calibrationValues);
+
+  if (!eepromWriter.write(calibrationRequest, calibrationStartAddr, calibrationBytes, calibrationRecordSize)) {
+    eepromWriter.flush();
+    eepromWriter.write(calibrationRequest, calibrationStartAddr, calibrationBytes, calibrationRecordSize);
+  }
+};
+
+#endif
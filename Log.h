@@ -0,0 +1,190 @@
+#pragma once
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include "LogMessages.h"
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+// the calls below this level are not compiled at all,
+// their arguments included
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+/*
+  Log a message of LogMessages.h with its arguments, e.g.
+    LOG_INFO(logTaskStatistics, task.name, task.runs, task.overruns, task.longestRun);
+  The numbers can be of any integer type, the strings are
+  sent up to their first logStringMaximumSize characters.
+*/
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logRecord(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) logRecord(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(...) logRecord(LOG_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logRecord(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+// a record starts with this marker, its low 2 bits being the level
+const byte logRecordMarker = 0xF0;
+const byte logRecordMaximumSize = 48;
+const byte logStringMaximumSize = 15;
+// bytes of the ring buffer: the indexes are bytes, so they wrap
+// around by themselves; enough for the statistics of a minute
+const unsigned int logBufferSize = 256;
+
+/*
+  A record, built before it goes in the buffer:
+  -> the marker with the level, then the message's index
+  -> every number as a varint (7 bits per byte, lowest first),
+     the signed ones as their 32 bit two's complement
+  -> every string as its bytes, ending with a 0
+  The decoder knows which argument is which from the format.
+*/
+struct LogRecord{
+  byte bytes[logRecordMaximumSize];
+  byte size;
+  // set when an argument did not fit, the record is not sent
+  bool isTooLong;
+
+  LogRecord(byte level, byte message): size(2), isTooLong(false) {
+    bytes[0] = logRecordMarker | level;
+    bytes[1] = message;
+  }
+
+  void addNumber(uint32_t value);
+  void add(const char *text);
+  void add(char *text){ add((const char *) text); }
+
+  template <class Number>
+  void add(Number value){ addNumber((uint32_t) (long) value); }
+};
+
+void LogRecord::addNumber(uint32_t value){
+  if (size + 5 > logRecordMaximumSize) {
+    isTooLong = true;
+    return;
+  }
+
+  while (value >= 0x80) {
+    bytes[size++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  bytes[size++] = value;
+}
+
+void LogRecord::add(const char *text){
+  if (size + logStringMaximumSize + 1 > logRecordMaximumSize) {
+    isTooLong = true;
+    return;
+  }
+
+  for (byte i = 0; i < logStringMaximumSize && text[i] != '\0'; i++) {
+    bytes[size++] = text[i];
+  }
+  bytes[size++] = '\0';
+}
+
+/*
+  The records waiting to be sent. Both the logging and the
+  draining run in the loop, so they need no locking; the serial
+  port's own interrupt sends what the drain hands over.
+*/
+struct LogBuffer{
+  byte bytes[logBufferSize];
+  byte head;
+  byte tail;
+  // records that did not fit, reported with the next one that does
+  unsigned long dropped;
+
+  LogBuffer(): head(0), tail(0), dropped(0) {}
+
+  byte freeSpace() const;
+  bool push(const LogRecord &record);
+  void drain();
+};
+
+LogBuffer logBuffer;
+
+byte LogBuffer::freeSpace() const{
+  return logBufferSize - 1 - (byte) (head - tail);
+}
+
+/*
+  Add the whole record, or nothing if it does not fit.
+*/
+bool LogBuffer::push(const LogRecord &record){
+  if (record.isTooLong || record.size > freeSpace()) {
+    dropped += 1;
+    return false;
+  }
+
+  for (byte i = 0; i < record.size; i++) {
+    bytes[head] = record.bytes[i];
+    head += 1;
+  }
+  return true;
+}
+
+/*
+  Hand the serial port as many bytes as its transmit buffer
+  takes without waiting; the rest waits for the next drain.
+*/
+void LogBuffer::drain(){
+  if (dropped > 0) {
+    LogRecord record(LOG_LEVEL_WARNING, logDropped);
+    record.add(dropped);
+
+    if (record.size <= freeSpace()) {
+      dropped = 0;
+      push(record);
+    }
+  }
+
+  int space = Serial.availableForWrite();
+
+  while (space > 0 && tail != head) {
+    Serial.write(bytes[tail]);
+    tail += 1;
+    space -= 1;
+  }
+}
+
+inline void logArguments(LogRecord &){}
+
+template <class First, class... Rest>
+void logArguments(LogRecord &record, First first, Rest... rest){
+  record.add(first);
+  logArguments(record, rest...);
+}
+
+template <class... Arguments>
+void logRecord(byte level, LogMessage message, Arguments... arguments){
+  LogRecord record(level, message);
+  logArguments(record, arguments...);
+  logBuffer.push(record);
+}
+
+#endif
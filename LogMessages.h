@@ -0,0 +1,32 @@
+#pragma once
+#ifndef LOG_MESSAGES_H
+#define LOG_MESSAGES_H
+
+/*
+  Every message the board can log, with the format the host
+  decoder prints it with. The board only sends the message's
+  index in this list and its arguments, the formats are only
+  compiled into tools/LogDecoder.cpp. New messages go at the
+  end, so the old captures still decode.
+
+  The formats take %lu for the unsigned numbers, %ld for
+  the signed ones and %s for the strings.
+*/
+#define LOG_MESSAGES(message) \
+  message(logDropped, "%lu log records dropped") \
+  message(logMatrixBrightnessTyped, "matrix brightness typed: %ld") \
+  message(logTaskStatistics, "task %s: runs %lu, overruns %lu, longest %lu us") \
+  message(logLoopStatistics, "loop: %lu ticks, min %lu us, avg %lu us, max %lu us, p99 %lu us, over budget %lu") \
+  message(logJobStatistics, "job %s: runs %lu, slices last %lu, most %lu, longest %lu us") \
+  message(logAutoPlayStatistics, "autoplay: games %lu, won %lu, deaths %lu") \
+  message(logBootTime, "boot: %lu us, EEPROM %lu us, budget %lu us") \
+  message(logMemoryStatistics, "memory: %lu bytes free, %lu never reached by the stack")
+
+#define LOG_MESSAGE_ID(id, format) id,
+
+enum LogMessage{
+  LOG_MESSAGES(LOG_MESSAGE_ID)
+  logMessagesSize
+};
+
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+#ifndef LOOP_TIMING_H
+#define LOOP_TIMING_H
+
+#include "Platform.h"
+#include "Log.h"
+
+// width of a histogram bucket, as a power of two of µs (512 µs)
+const byte loopTimingBucketShift = 9;
+// the last bucket also keeps every loop longer than the others
+const byte loopTimingBuckets = 32;
+
+/*
+  How long the loops that ran a tick took: the shortest, the
+  average and the longest, a histogram of 512 µs buckets for the
+  percentiles, and how many loops went over their budget.
+*/
+struct LoopTiming{
+  // time a loop can take without delaying the next frame, in µs
+  unsigned long budget;
+
+  unsigned long loops;
+  unsigned long shortest;
+  unsigned long longest;
+  unsigned long total;
+  unsigned int overBudget;
+  unsigned int buckets[loopTimingBuckets];
+
+  LoopTiming(unsigned long budget): budget(budget) {
+    reset();
+  }
+
+  void reset();
+  void add(unsigned long duration);
+  unsigned long percentile(byte percent);
+  void printStatistics();
+};
+
+void LoopTiming::reset(){
+  loops = 0;
+  shortest = 0xFFFFFFFFUL;
+  longest = 0;
+  total = 0;
+  overBudget = 0;
+
+  for (byte i = 0; i < loopTimingBuckets; i++) {
+    buckets[i] = 0;
+  }
+}
+
+/*
+  Count a loop that took duration µs.
+*/
+void LoopTiming::add(unsigned long duration){
+  loops += 1;
+  total += duration;
+
+  if (duration < shortest) {
+    shortest = duration;
+  }
+  if (duration > longest) {
+    longest = duration;
+  }
+  if (duration > budget) {
+    overBudget += 1;
+  }
+
+  unsigned long bucket = duration >> loopTimingBucketShift;
+  if (bucket >= loopTimingBuckets) {
+    bucket = loopTimingBuckets - 1;
+  }
+  // stop counting before the bucket wraps around
+  if (buckets[bucket] < 0xFFFF) {
+    buckets[bucket] += 1;
+  }
+}
+
+/*
+  Time under which the given percent of the loops finished,
+  in µs, rounded up to the end of its bucket.
+*/
+unsigned long LoopTiming::percentile(byte percent){
+  unsigned long counted = 0;
+
+  for (byte i = 0; i < loopTimingBuckets; i++) {
+    counted += buckets[i];
+
+    if (counted * 100 >= loops * percent) {
+      unsigned long end = (unsigned long) (i + 1) << loopTimingBucketShift;
+      return end < longest ? end : longest;
+    }
+  }
+
+  return longest;
+}
+
+/*
+  Log the loop times.
+*/
+void LoopTiming::printStatistics(){
+  if (loops == 0) {
+    return;
+  }
+
+  LOG_INFO(logLoopStatistics, loops, shortest, total / loops, longest, percentile(99), overBudget);
+}
+
+#endif
@@ -4,108 +4,160 @@
 
 #include "Game.h"
 #include "pitches.h"
-
-int melodyNBC[] = {
-  NOTE_G4, NOTE_G4, NOTE_G4, NOTE_G4, NOTE_G4, NOTE_GS4, NOTE_F4, NOTE_F4,
-  NOTE_F4, NOTE_F4, NOTE_F4, NOTE_F4, NOTE_F4, NOTE_F4, NOTE_F4, NOTE_G4, NOTE_GS4, NOTE_G4,
-  NOTE_G4, NOTE_G4, NOTE_G4, NOTE_G4, NOTE_A4, NOTE_AS4, NOTE_A4, NOTE_G4, NOTE_F4,
-  NOTE_F4, NOTE_F4, NOTE_F4, NOTE_G4, NOTE_GS4, NOTE_G4, NOTE_DS4, NOTE_D4, NOTE_G4,
+#include "Song.h"
+#include "Sequencer.h"
+#include "DistanceField.h"
+#include "Scheduler.h"
+
+// Q8 tempos of the game's melody on the levels 2 and 3
+const unsigned int themeTempoLevel2 = 192;
+const unsigned int themeTempoLevel3 = 128;
+// moves between Dr. Nocturne and the player under
+// which the game's melody starts to speed up
+const byte tensionDistance = 8;
+// Q8 part of the tempo taken off for every move closer
+const byte tensionStep = 12;
+
+// the songs are in flash, written in the format of Song.h
+constexpr byte themeSong[] PROGMEM = {
+  note(NOTE_G4, 125), note(NOTE_G4, 125), note(NOTE_G4, 125), note(NOTE_G4, 125),
+  note(NOTE_G4, 62), note(NOTE_GS4, 62), note(NOTE_F4, 125), note(NOTE_F4, 250),
+  note(NOTE_F4, 62), note(NOTE_F4, 62), note(NOTE_F4, 125), note(NOTE_F4, 62),
+  note(NOTE_F4, 62), note(NOTE_F4, 125), note(NOTE_F4, 62), note(NOTE_G4, 62), note(NOTE_GS4, 125), note(NOTE_G4, 250),
+  note(NOTE_G4, 125), note(NOTE_G4, 125), note(NOTE_G4, 125), note(NOTE_G4, 62),
+  note(NOTE_A4, 62), note(NOTE_AS4, 125), note(NOTE_A4, 62), note(NOTE_G4, 62), note(NOTE_F4, 250),
+  note(NOTE_F4, 125), note(NOTE_F4, 125), note(NOTE_F4, 62), note(NOTE_G4, 62),
+  note(NOTE_GS4, 125), note(NOTE_G4, 125), note(NOTE_DS4, 125), note(NOTE_D4, 125), note(NOTE_G4, 125),
+  songEnd
 };
 
-byte durationsNBC[] = {
-  125, 125, 125, 125, 62, 62, 125, 250,
-  62, 62, 125, 62, 62, 125, 62, 62, 125, 250,
-  125, 125, 125, 62, 62, 125, 62, 62, 250,
-  125, 125, 62, 62, 125, 125, 125, 125, 125,
+constexpr byte noteFoundSong[] PROGMEM = {
+  rest(100),
+  songRepeatStart,
+  note(NOTE_G5, 100), note(NOTE_B5, 100), note(NOTE_D6, 100),
+  songRepeatEnd,
+  rest(100),
+  songEnd
 };
 
-int noteFoundMelody[] = {
-  REST, NOTE_G5, NOTE_B5, NOTE_D6, NOTE_G5, NOTE_B5, NOTE_D6, REST
+constexpr byte playerDeathSong[] PROGMEM = {
+  rest(100),
+  note(NOTE_A2, 100), note(NOTE_G2, 100), note(NOTE_E2, 100), note(NOTE_D2, 100), note(NOTE_C2, 100),
+  rest(100),
+  songEnd
 };
 
-byte noteFoundDurations[] = {
-  100, 100, 100, 100, 100, 100, 100, 100
-};
+// the times of the last note found and of the last death
+// the effects were played for
+unsigned long noteFoundEffectTime = 0;
+unsigned long playerDeathEffectTime = 0;
 
-int playerDeathMelody[] = {
-  REST, NOTE_A2, NOTE_G2, NOTE_E2, NOTE_D2, NOTE_C2, REST
-};
+// positions the doctor's distance was measured for, 0 while he is
+// not active in the player's room; the distance is in moves
+unsigned int doctorDistancePositions = 0;
+byte doctorDistance = unreachableDistance;
+// tempo of the game's melody, and the level it was computed for
+unsigned int themeTempo = sequencerNormalTempo;
+byte themeTempoLevel = 0;
 
-byte playerDeathDurations[] = {
-  100, 100, 100, 100, 100, 100, 100
-};
+/*
+  Measure how many moves Dr. Nocturne needs to reach the player,
+  while he is active in the player's room; it is only measured
+  again after one of them has moved. Returns true if it changed.
+*/
+bool updateDoctorDistance(const Game &game){
+  unsigned int positions = 0;
+
+  if (game.isRunning && (game.doctor.isWaiting || game.doctor.isChasing)
+      && game.doctor.currentRoom == game.player.currentRoom) {
+    positions = 1 + ((game.player.currentRoom << 12) | (game.player.row << 9) | (game.player.column << 6)
+                     | (game.doctor.row << 3) | game.doctor.column);
+  }
+
+  if (positions == doctorDistancePositions) {
+    return false;
+  }
+  doctorDistancePositions = positions;
+
+  byte distance = unreachableDistance;
+  if (positions != 0) {
+    distance = roomDistance(game.player.currentRoom, game.doctor.row, game.doctor.column,
+                            game.player.row, game.player.column);
+  }
+
+  if (distance == doctorDistance) {
+    return false;
+  }
 
-unsigned long previousNoteTime = 0;
-unsigned long currentNote = 0;
-bool playingMelody = false;
+  doctorDistance = distance;
+  return true;
+}
 
 /*
-  Given the pin to which the buzzer is connected, a melody and
-  its notes durations, use the tone function to reproduce 
-  the melody, with a small delay between notes
+  The game's melody is faster on the higher levels, and gets
+  faster still, a step for every move, as Dr. Nocturne closes in.
 */
-void playMelody(const byte buzzerPin, const int melody[], const byte durations[], const byte sizeOfMelody, float duration){
-  unsigned long currentNoteTime = millis();
-  
-  if (playingMelody) {
-    if ((currentNoteTime - previousNoteTime) >= durations[currentNote] * duration) {
-      previousNoteTime = currentNoteTime;
-      tone(buzzerPin, melody[currentNote], durations[currentNote]);
-      playingMelody = false;
-
-      currentNote += 1;
-      if (currentNote >= sizeOfMelody) {
-        currentNote = 0;
-      }
-    }
-  } else {
-    if ((currentNoteTime - previousNoteTime) >= durations[currentNote] * 1.3) {
-      previousNoteTime = currentNoteTime;
-      noTone(buzzerPin);
-      playingMelody = true;
-    }
+unsigned int gameMelodyTempo(const Game &game){
+  unsigned int tempo = sequencerNormalTempo;
+  if (game.isRunning && game.doctor.level == 2) {
+    tempo = themeTempoLevel2;
+  } else if (game.isRunning && game.doctor.level == 3) {
+    tempo = themeTempoLevel3;
+  }
+
+  if (doctorDistance < tensionDistance) {
+    unsigned int tension = sequencerNormalTempo - tensionStep * (tensionDistance - doctorDistance);
+    tempo = (tempo * tension) >> 8;
   }
-};
+
+  return tempo;
+}
 
 /*
   Depending on the sound settings set by the user
   and state of the game, play different melodies.
 
-  A special melody will be played when the user has found a note.
+  A special melody will be played when the user has found a note,
+  and another one when he was found by Dr. Nocturne; both are
+  played once, as effects over the game melody.
 
   The game melody will play the entire time, if the sound
   setting is set to on, obviously.
+
+  The sequencer plays the notes in the background; this
+  only tells it what to play, and how fast.
 */
-void playGameMelody(const byte buzzerPin, bool soundIsOn, Game game){
+void playGameMelody(bool soundIsOn, const Game &game, unsigned long now){
+  bool hasFoundNote = game.lastNoteFound != noteFoundEffectTime;
+  bool hasDied = game.lastDeath != playerDeathEffectTime;
+
+  noteFoundEffectTime = game.lastNoteFound;
+  playerDeathEffectTime = game.lastDeath;
+
   // if sound is off, exit imediately
   if (!soundIsOn) {
+    sequencer.stop();
     return;
   }
 
-  // prioritize player foundin a note by first checking if he found a note recently enough
-  if ((millis() - game.lastNoteFound) <= 2000 && game.player.notes > 0) {
-    playMelody(buzzerPin, noteFoundMelody, noteFoundDurations, sizeof(noteFoundMelody) / sizeof(noteFoundMelody[0]), 1.00);
+  // prioritize player found by Dr. Nocturne
+  if (hasDied) {
+    sequencer.playEffect(playerDeathSong);
+  } else if (hasFoundNote) {
+    sequencer.playEffect(noteFoundSong);
   }
-  // also prioritize player being found by Dr. Nocturne
-  else if ((millis() - game.lastDeath) <= 2000 && game.player.lives < 3) { 
-    Serial.println("mama");
-    playMelody(buzzerPin, playerDeathMelody, playerDeathDurations, sizeof(playerDeathMelody) / sizeof(playerDeathMelody[0]), 1.00);
-  }
-  // otherwise, if the game is running and doctor has level 2, speed up
-  // the game's melody
-  else if (game.isRunning && game.doctor.level == 2) {
-    playMelody(buzzerPin, melodyNBC, durationsNBC, sizeof(melodyNBC) / sizeof(melodyNBC[0]), 0.75);
-  } 
-  // if the game is running and doctor has level 3, speed up 
-  // even more, because its the hardest level
-  else if (game.isRunning && game.doctor.level == 3) {
-    playMelody(buzzerPin, melodyNBC, durationsNBC, sizeof(melodyNBC) / sizeof(melodyNBC[0]), 0.5);
-  } 
-  // if no special case is happening, just play the normal melody
-  else {
-    playMelody(buzzerPin, melodyNBC, durationsNBC, sizeof(melodyNBC) / sizeof(melodyNBC[0]), 1.00);
+
+  // the tempo follows the level and how close Dr. Nocturne
+  // is, so it only changes when one of them does
+  byte level = game.isRunning ? game.doctor.level : 0;
+  if (updateDoctorDistance(game) || level != themeTempoLevel) {
+    themeTempoLevel = level;
+    themeTempo = gameMelodyTempo(game);
   }
-}
 
+  sequencer.playMusic(themeSong, themeTempo);
+
+  sequencer.update(now);
+}
 
 #endif
\ No newline at end of file
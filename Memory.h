@@ -0,0 +1,83 @@
+#pragma once
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include "Platform.h"
+
+// the free RAM is filled with this at boot, so the bytes
+// the stack never reached can be told from the others
+const byte memoryPaint = 0xC5;
+// bytes under the stack pointer left alone by the painting,
+// as the function doing it still uses them
+const byte memoryPaintMargin = 32;
+
+/*
+  The RAM of the board (2 KB) holds the globals, then the heap
+  growing up, and the stack growing down from its end. The bytes
+  between the heap and the stack are free; the lowest the stack
+  has ever gone is found by painting them at boot and counting,
+  later, the ones still painted.
+*/
+#ifdef __AVR__
+
+extern char __heap_start;
+extern char *__brkval;
+
+char *heapEnd(){
+  return __brkval != NULL ? __brkval : &__heap_start;
+}
+
+void paintMemory(){
+  char top;
+
+  for (char *address = heapEnd(); address < &top - memoryPaintMargin; address++) {
+    *address = memoryPaint;
+  }
+}
+
+/*
+  Paint again the bytes a free() gave back to the heap's end,
+  up to where it ended before, as they were painted until the
+  heap took them; unusedMemory() counts from the heap's end.
+*/
+void repaintFreedMemory(char *previousEnd){
+  for (char *address = heapEnd(); address < previousEnd; address++) {
+    *address = memoryPaint;
+  }
+}
+
+/*
+  Bytes between the heap and the stack right now.
+*/
+unsigned int freeMemory(){
+  char top;
+  return &top - heapEnd();
+}
+
+/*
+  Bytes above the heap the stack has never reached: how much
+  it could still grow, at its deepest so far.
+*/
+unsigned int unusedMemory(){
+  char top;
+  unsigned int unused = 0;
+
+  for (char *address = heapEnd(); address < &top && *address == (char) memoryPaint; address++) {
+    unused += 1;
+  }
+
+  return unused;
+}
+
+#else
+
+// the host has no such limit, nothing to measure
+char *heapEnd(){ return NULL; }
+void paintMemory(){}
+void repaintFreedMemory(char *){}
+unsigned int freeMemory(){ return 0; }
+unsigned int unusedMemory(){ return 0; }
+
+#endif
+
+#endif
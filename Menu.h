@@ -8,23 +8,27 @@
 
 #include "EEPROM.h"
 
+#include "AutoPlayer.h"
+#include "EepromSchema.h"
 #include "Game.h"
 #include "JoyStick.h"
 #include "Highscores.h"
+#include "Memory.h"
 #include "MenuInput.h"
 #include "MenuDisplay.h"
 #include "Melody.h"
-#include "Rooms.h"
+#include "RoomsDisplay.h"
 #include "Utils.h"
+#include "Scheduler.h"
 
-const byte mainMenuMessagesSize = 4;
+const byte mainMenuMessagesSize = 5;
 const char* mainMenuMessages[mainMenuMessagesSize] = {
-  "Start game", "Highscores", "Settings", "About",
+  "Start game", "Continue", "Highscores", "Settings", "About",
 };
 
-const byte settingsMenuSize = 6;
+const byte settingsMenuSize = 7;
 const char* settingsMenu[settingsMenuSize] = {
-  "Enter name", "LCD bright", "Matrix bright", "Reset scores", "Sound", "Back"
+  "Enter name", "LCD bright", "Matrix bright", "Reset scores", "Sound", "Calibrate", "Back"
 };
 
 const byte gameEndedMenuSize = 2;
@@ -58,6 +62,16 @@ char username[usernameSize] = {' ', ' ', ' '};
 const byte letterAlphabetSize = 26;
 
 const int resetTimeInterval = 2000;
+const int noSavedGameTimeInterval = 2000;
+
+// steps of the joystick calibration
+const byte calibrationStepCenter = 0;
+const byte calibrationStepSamplingCenter = 1;
+const byte calibrationStepExtremes = 2;
+const byte calibrationStepDone = 3;
+// the stick was not moved to its edges, the last calibration stays
+const byte calibrationStepFailed = 4;
+const int calibrationDoneTimeInterval = 2000;
 
 struct Menu{
   LiquidCrystal lcd;
@@ -69,7 +83,16 @@ struct Menu{
   bool sound;
 
   unsigned long highscoresResetTime;
+  unsigned long noSavedGameTime;
+
+  // state of the joystick calibration
+  byte calibrationStep;
+  unsigned long calibrationStepTime;
+  CalibrationSampler calibrationCenter;
+  CalibrationSampler calibrationExtremes;
   unsigned long gameStartTime;
+  // last time the joystick was touched on the welcome screen
+  unsigned long lastInteractionTime;
 
   byte lcdBrightness;
   byte matrixBrightness;
@@ -81,29 +104,32 @@ struct Menu{
 
   Game game;
   MenuInput menuInput;
+  // only there while the autoplayer plays, so its distance
+  // field takes no RAM the rest of the time
+  AutoPlayer *autoPlayer;
 
   Menu(byte RS, byte EN, byte D4, byte D5, byte D6, byte D7, 
        byte dinPin, byte clockPin, byte loadPin, 
        byte buzzerPin, byte lcdBrightnessPin): 
-       lcd(RS, EN, D4, D5, D6, D7), lc(dinPin, clockPin, loadPin, 1), game(this->lc){    
+       lcd(RS, EN, D4, D5, D6, D7), lc(dinPin, clockPin, loadPin, 1){    
     this->buzzerPin = buzzerPin;
     this->lcdBrightnessPin = lcdBrightnessPin;
 
     soundExitBlinking = false;
+    lastInteractionTime = 0;
     
     currentMenu = 0;
     arrowMenuPosition = 0;
     arrowMenuLinePosition = 0;
     currentMenuPosition = 0; 
+    autoPlayer = NULL;
 
     lc.shutdown(0, false);
     lc.clearDisplay(0);
-    
-    loadMenuSettings();
-    activateMenuSettins();
   }
 
   // functions to load and activate settings
+  void begin();
   void loadMenuSettings();
   void activateMenuSettins();
   
@@ -111,8 +137,14 @@ struct Menu{
   void displayWelcomeMessage();
   void welcomeMessageHandler(Joystick &joystick);
 
+  // functions related to the attract mode
+  void idleHandler(Joystick &joystick);
+  void autoPlayHandler(Joystick &joystick);
+  void stopAutoPlay();
+
   // functions related to the whole menu functionality
   void menuSwitch(Joystick &joystick);
+  void melodyHandler(unsigned long now);
   void menuWatcher(int maximumMenuSize, Joystick &joystick);
 
   // functions to handle main menu
@@ -120,6 +152,7 @@ struct Menu{
 
   // functions related to game menu
   void gameMenuHandler(Joystick &joystick);
+  void noSavedGameHandler();
 
   // funtions related to the highscores menu
   void highscoresMenuHandler(Joystick &joystick);
@@ -131,6 +164,7 @@ struct Menu{
   void matrixBrightnessMenuHandler(Joystick &joystick);
   void resetHighscoresHandler();
   void soundToggleHandler(Joystick &joystick);
+  void calibrationHandler(Joystick &joystick);
 
   // functions related to about menu
   void aboutMenuHandler(Joystick &joystick);
@@ -140,17 +174,30 @@ struct Menu{
   void resetUserInput(char userInput[], byte userInputSize);
 };
 
+/*
+  Load the settings and activate them, from setup(): the EEPROM
+  might have to be written, which needs the interrupts on.
+*/
+void Menu::begin(){
+  loadMenuSettings();
+  activateMenuSettins();
+};
+
 /*
   Load brightness and sound settings, as well as the 
   highscores with their associated names from EEPROM memory.
 */
 void Menu::loadMenuSettings(){
+  // checked, and migrated from an older layout if needed
+  loadEeprom();
+  loadSavedGames();
+
   // load the LCD brightness setting
-  EEPROM.get(0, lcdBrightness);
+  store.get(lcdBrightnessAddr, lcdBrightness);
   // load the matrix brightness setting
-  EEPROM.get(1, matrixBrightness);
+  store.get(matrixBrightnessAddr, matrixBrightness);
   // load the sound setting
-  EEPROM.get(2, sound);
+  store.get(soundAddr, sound);
 
   loadPlayersHighschores();
 };
@@ -183,6 +230,80 @@ void Menu::welcomeMessageHandler(Joystick &joystick){
   }
 };
 
+/*
+  When nobody touches the joystick on the welcome screen for
+  autoPlayerIdleTimeout, the autoplayer starts playing games.
+*/
+void Menu::idleHandler(Joystick &joystick){
+  if (joystick.isTouched()) {
+    lastInteractionTime = tickNow;
+    return;
+  }
+
+  if ((tickNow - lastInteractionTime) < autoPlayerIdleTimeout) {
+    return;
+  }
+
+  // without the RAM for it, the welcome screen just stays
+  autoPlayer = new AutoPlayer();
+  if (autoPlayer == NULL) {
+    lastInteractionTime = tickNow;
+    return;
+  }
+
+  autoPlayer->start(boardRandom.next());
+  game.reset(lc);
+  game.isAutoPlaying = true;
+
+  lcd.clear();
+  currentMenu = 5;
+};
+
+/*
+  Let the autoplayer play games one after another, until
+  somebody touches the joystick; then go back to the welcome screen.
+*/
+void Menu::autoPlayHandler(Joystick &joystick){
+  if (joystick.isTouched()) {
+    stopAutoPlay();
+    return;
+  }
+
+  if (game.isRunning || game.isDisplayingEndMessage) {
+    game.play(lc, lcd, autoPlayer->update(game));
+
+    // make it clear nobody is playing
+    if (game.isRunning && !game.isInPause) {
+      lcd.setCursor(12, 1);
+      lcd.print("DEMO");
+    }
+    return;
+  }
+
+  // the end messages were displayed, start the next game
+  autoPlayer->gameEnded(game);
+  autoPlayer->newGame();
+  game.reset(lc);
+};
+
+void Menu::stopAutoPlay(){
+  char *heapUsed = heapEnd();
+  delete autoPlayer;
+  autoPlayer = NULL;
+  // its bytes were the heap's last ones, the stack never used them
+  repaintFreedMemory(heapUsed);
+
+  game.isAutoPlaying = false;
+  game.isRunning = false;
+  game.isDisplayingEndMessage = false;
+
+  resetMatrix(lc);
+  lcd.clear();
+
+  lastInteractionTime = tickNow;
+  currentMenu = 0;
+};
+
 /*
   Acts as a central control point for managing different
   menus, depending where the user is currently at.
@@ -199,6 +320,11 @@ void Menu::menuSwitch(Joystick &joystick){
     case 0:
       displayWelcomeMessage();
       welcomeMessageHandler(joystick);
+      idleHandler(joystick);
+      break;
+    case 5:
+      // attract mode, the autoplayer plays the game
+      autoPlayHandler(joystick);
       break;
     case 1:
       displayMenu(lcd, mainMenuMessages, currentMenuPosition, arrowMenuLinePosition);
@@ -210,11 +336,15 @@ void Menu::menuSwitch(Joystick &joystick){
       // display game menu
       gameMenuHandler(joystick);
       break;
+    case 12:
+      // there is no game to continue
+      noSavedGameHandler();
+      break;
     case 2:
       // display highscores
-      displayHighscores(lcd, playerNames, highscores, 3, currentMenuPosition, arrowMenuLinePosition);
+      displayHighscores(lcd, highscoresShown(), currentMenuPosition, arrowMenuLinePosition);
 
-      menuWatcher(4, joystick);
+      menuWatcher(highscoresShown() + 1, joystick);
       highscoresMenuHandler(joystick);
       break;
     case 3:
@@ -245,6 +375,10 @@ void Menu::menuSwitch(Joystick &joystick){
       // user needs to toggle the sound
       soundToggleHandler(joystick);
       break;
+    case 35:
+      // user calibrates the joystick
+      calibrationHandler(joystick);
+      break;
     case 4:
       // display about
       displayMenu(lcd, aboutMenu, currentMenuPosition, arrowMenuLinePosition);
@@ -255,8 +389,13 @@ void Menu::menuSwitch(Joystick &joystick){
     default:
       break;
   }
+};
 
-  playGameMelody(buzzerPin, sound, game);
+/*
+  Play the melody for the current state of the game.
+*/
+void Menu::melodyHandler(unsigned long now){
+  playGameMelody(sound, game, now);
 };
 
 /*
@@ -318,20 +457,31 @@ void Menu::mainMenuHandler(Joystick &joystick){
     switch (arrowMenuPosition) {
       case 0:
         // start the game
+        clearSavedGame();
         game.reset(lc);
-        gameStartTime = millis();
+        gameStartTime = tickNow;
 
         currentMenu = 11;
         break;
       case 1:
+        // continue the game saved in EEPROM, if there is one
+        if (game.restore(lc)) {
+          gameStartTime = tickNow;
+          currentMenu = 11;
+        } else {
+          noSavedGameTime = tickNow;
+          currentMenu = 12;
+        }
+        break;
+      case 2:
         // set menu to highscores
         currentMenu = 2;
         break;
-      case 2:
+      case 3:
         // set menu to settings
         currentMenu = 3;
         break;
-      case 3:
+      case 4:
         // set menu to about section
         currentMenu = 4;
         break;
@@ -347,7 +497,7 @@ void Menu::mainMenuHandler(Joystick &joystick){
 void Menu::gameMenuHandler(Joystick &joystick){
   // if the user has set its name, display a "good luck" message
   // before starting the game
-  if ((millis() - gameStartTime) <= gameSpecialMomentsTimeInterval 
+  if ((tickNow - gameStartTime) <= gameSpecialMomentsTimeInterval 
       && game.player.hasUserName) {
     displayGameStartedMessage(lcd, username, usernameCompletedSize);
     return;
@@ -355,10 +505,10 @@ void Menu::gameMenuHandler(Joystick &joystick){
 
   // smooth transition between "good luck" message and actually
   // starting the game
-  if ((millis() - gameStartTime) <= gameSpecialMomentsTimeInterval + transitionTime 
+  if ((tickNow - gameStartTime) <= gameSpecialMomentsTimeInterval + transitionTime 
        && game.player.hasUserName) {
     lcd.clear();
-    game.lastTimeIncrement = millis();
+    game.lastStepTime = tickNow;
     return;
   }
 
@@ -379,8 +529,7 @@ void Menu::gameMenuHandler(Joystick &joystick){
   // if the player has a highscore, update the highscore array,
   // write it to EEPROM and stop displaying the "new highscore" message
   if (game.player.hasHighscore) {
-    updateHighscores(game.time, username);
-    writeHighscores();
+    updateHighscores(game.centiseconds(), username);
     game.player.hasHighscore = false;
     return;
   }
@@ -392,8 +541,9 @@ void Menu::gameMenuHandler(Joystick &joystick){
       switch (arrowMenuPosition) {
         case 0:
           // user chose to play again
+          clearSavedGame();
           game.reset(lc);
-          gameStartTime = millis();
+          gameStartTime = tickNow;
 
           currentMenu = 11;
           break;
@@ -417,13 +567,10 @@ void Menu::highscoresMenuHandler(Joystick &joystick){
   if (joystick.currentSwitchStateChanged == HIGH) {
     // depending where the user is pointing,
     // handle each individual case
-    switch (arrowMenuPosition) {
-      case 3:
-        // go back to the main menu
-        currentMenu = 1;
-        break;
-      default:
-        break;
+    // go back to the main menu, from the
+    // option after the highscores
+    if (arrowMenuPosition == highscoresShown()) {
+      currentMenu = 1;
     }
     // reset the menu
     resetMenu();
@@ -465,7 +612,7 @@ void Menu::settingsMenuHandler(Joystick &joystick){
       case 3:
         // reset the highscores
         lcd.clear();
-        highscoresResetTime = millis();
+        highscoresResetTime = tickNow;
         currentMenu = 33;
         break;
       case 4:
@@ -473,6 +620,12 @@ void Menu::settingsMenuHandler(Joystick &joystick){
         currentMenu = 34;
         break;
       case 5:
+        // calibrate the joystick
+        lcd.clear();
+        calibrationStep = calibrationStepCenter;
+        currentMenu = 35;
+        break;
+      case 6:
         // go back to the main menu
         currentMenu = 1;
         break;
@@ -543,7 +696,8 @@ void Menu::lcdBrightnessMenuHandler(Joystick &joystick){
     // clear the lcd and go to the parent menu
      if (menuInput.currentCursorColumnPosition == exitPosition) {
       analogWrite(lcdBrightnessPin, lcdBrightness);
-      EEPROM.put(0, lcdBrightness);
+      store.put(lcdBrightnessAddr, lcdBrightness);
+      store.save();
 
       lcd.clear();
       menuInput.resetInputVariables();
@@ -570,7 +724,8 @@ void Menu::matrixBrightnessMenuHandler(Joystick &joystick){
     // clear the lcd and go to the parent menu
      if (menuInput.currentCursorColumnPosition == exitPosition) {
       lc.setIntensity(0, matrixBrightness);
-      EEPROM.put(1, matrixBrightness);
+      store.put(matrixBrightnessAddr, matrixBrightness);
+      store.save();
 
       lcd.clear();
       menuInput.resetInputVariables();
@@ -581,11 +736,25 @@ void Menu::matrixBrightnessMenuHandler(Joystick &joystick){
   }
 };
 
+/*
+  Let the user know there is no saved game,
+  then return to the main menu.
+*/
+void Menu::noSavedGameHandler(){
+  if ((tickNow - noSavedGameTime) <= noSavedGameTimeInterval) {
+    displayMessageInCenter(lcd, "No saved game", 0);
+    return;
+  }
+
+  lcd.clear();
+  currentMenu = 1;
+}
+
 void Menu::resetHighscoresHandler(){
   // before returning to the parent menu, display
   // a message in which the user is acknowledged that
   // that the highscores were reset succesfully
-  if ((millis() - highscoresResetTime) <= resetTimeInterval) {
+  if ((tickNow - highscoresResetTime) <= resetTimeInterval) {
     displayMessageInCenter(lcd, "Highscores reset", 0);
     displayMessageInCenter(lcd, "successfully.", 1);
     return;
@@ -597,6 +766,72 @@ void Menu::resetHighscoresHandler(){
   currentMenu = 3;
 }
 
+/*
+  Calibrate the joystick in a few steps:
+  -> the stick is left in the middle, until the switch is pressed
+  -> the middle and its noise are sampled for a second
+  -> the stick is moved to all its edges, until the switch is pressed
+  Then the calibration is saved in EEPROM and used right away.
+*/
+void Menu::calibrationHandler(Joystick &joystick){
+  switch (calibrationStep) {
+    case calibrationStepCenter:
+      displayMessageInCenter(lcd, "Leave stick in", 0);
+      displayMessageInCenter(lcd, "middle & press", 1);
+
+      if (joystick.currentSwitchStateChanged == HIGH) {
+        lcd.clear();
+        calibrationCenter.reset();
+        calibrationStepTime = tickNow;
+        calibrationStep = calibrationStepSamplingCenter;
+      }
+      break;
+    case calibrationStepSamplingCenter:
+      displayMessageInCenter(lcd, "Hold still...", 0);
+      calibrationCenter.add(joystick.axisValueX, joystick.axisValueY);
+
+      if ((tickNow - calibrationStepTime) > calibrationCenterInterval) {
+        lcd.clear();
+        calibrationExtremes.reset();
+        calibrationStep = calibrationStepExtremes;
+      }
+      break;
+    case calibrationStepExtremes:
+      displayMessageInCenter(lcd, "Move to edges", 0);
+      displayMessageInCenter(lcd, "then press", 1);
+      calibrationExtremes.add(joystick.axisValueX, joystick.axisValueY);
+
+      if (joystick.currentSwitchStateChanged == HIGH) {
+        calibrationStep = calibrationStepFailed;
+
+        if (finishCalibration(calibrationCenter, calibrationExtremes, joystick.calibration)) {
+          writeCalibration(joystick.calibration);
+          calibrationStep = calibrationStepDone;
+        }
+
+        lcd.clear();
+        calibrationStepTime = tickNow;
+      }
+      break;
+    default:
+      // before returning to the parent menu, let the
+      // user know if the joystick was calibrated
+      if ((tickNow - calibrationStepTime) <= calibrationDoneTimeInterval) {
+        if (calibrationStep == calibrationStepDone) {
+          displayMessageInCenter(lcd, "Calibrated", 0);
+        } else {
+          displayMessageInCenter(lcd, "Not calibrated", 0);
+          displayMessageInCenter(lcd, "move to edges", 1);
+        }
+        return;
+      }
+
+      lcd.clear();
+      currentMenu = 3;
+      break;
+  }
+}
+
 void Menu::soundToggleHandler(Joystick &joystick){
   // listen to joystick movements to move from setting the
   // sound to the exit sign on the right of the LCD
@@ -622,7 +857,8 @@ void Menu::soundToggleHandler(Joystick &joystick){
     // otherwise, toggle the sound buttton
     else {
       sound = !sound;
-      EEPROM.put(2, sound);
+      store.put(soundAddr, sound);
+      store.save();
     }
   }
 
@@ -5,6 +5,8 @@
 #include "LiquidCrystal.h"
 #include "CustomCharacters.h"
 #include "ConstantsHighscore.h"
+#include "Highscores.h"
+#include "Scheduler.h"
 
 const byte lcdBlinkingInterval = 500;
 bool displayBlinking = true;
@@ -15,9 +17,9 @@ unsigned long lastBlinkingChar = 0;
   position, depending on the blinking control variable
 */
 void displayBlinkingInt(LiquidCrystal &lcd, const int message, const int line, const int column){
-    if ((millis() - lastBlinkingChar) > lcdBlinkingInterval) {
+    if ((tickNow - lastBlinkingChar) > lcdBlinkingInterval) {
       displayBlinking = !displayBlinking;
-      lastBlinkingChar = millis();
+      lastBlinkingChar = tickNow;
     }
 
     if (displayBlinking) {
@@ -34,9 +36,9 @@ void displayBlinkingInt(LiquidCrystal &lcd, const int message, const int line, c
   position, depending on the blinking control variable.
 */
 void displayBlinkingChar(LiquidCrystal &lcd, const char message, const int line, const int column){
-    if ((millis() - lastBlinkingChar) > lcdBlinkingInterval) {
+    if ((tickNow - lastBlinkingChar) > lcdBlinkingInterval) {
       displayBlinking = !displayBlinking;
-      lastBlinkingChar = millis();
+      lastBlinkingChar = tickNow;
     }
 
     if (displayBlinking) {
@@ -49,9 +51,9 @@ void displayBlinkingChar(LiquidCrystal &lcd, const char message, const int line,
 };
   
 void displayBlinkingByte(LiquidCrystal &lcd, const byte message, const int line, const int column){
-    if ((millis() - lastBlinkingChar) > lcdBlinkingInterval) {
+    if ((tickNow - lastBlinkingChar) > lcdBlinkingInterval) {
       displayBlinking = !displayBlinking;
-      lastBlinkingChar = millis();
+      lastBlinkingChar = tickNow;
     }
 
     if (displayBlinking) {
@@ -95,7 +97,7 @@ void displayMessageInCenterWithSkull(LiquidCrystal &lcd, const char* message,  c
 */
 void resetBlinkingVariables(){
   displayBlinking = true;
-  lastBlinkingChar = millis();
+  lastBlinkingChar = tickNow;
 };
 
 /*
@@ -186,8 +188,28 @@ void displayTimeFromSeconds(LiquidCrystal &lcd, const unsigned int time, const b
   }
 };
 
+/*
+  Display the time as mm:ss.cc, 8 characters
+  starting from the given column.
+*/
+void displayTimeFromCentiseconds(LiquidCrystal &lcd, const unsigned long time, const byte column, const byte line) {
+  unsigned int centiseconds = time % 100;
+
+  displayTimeFromSeconds(lcd, time / 100, column, line);
+
+  lcd.setCursor(column + 5, line);
+  lcd.print(".");
+
+  // also display a 0 before the centiseconds under 10
+  lcd.setCursor(column + 6, line);
+  if (centiseconds < 10) {
+    lcd.print("0");
+  }
+  lcd.print(centiseconds);
+};
+
 void displayPlayerAndScore(LiquidCrystal &lcd, char playerName[playerNameSize], const unsigned long score, const byte line){
-  if (score == 900) {
+  if (score == highscoreDefaultValue) {
     lcd.setCursor(4, line);
     lcd.print("none");
   } else {
@@ -198,16 +220,21 @@ void displayPlayerAndScore(LiquidCrystal &lcd, char playerName[playerNameSize],
       }
       
       // display the score of the player
-      displayTimeFromSeconds(lcd, score, 8, line);
+      displayTimeFromCentiseconds(lcd, score, 8, line);
   }
 }
 
 /*
-  Given an array of player names, their scores, and a index,
-  display the ranking symbol, the name and the score of the players
-  on each line of the LCD.
+  Given the number of places to show and a index, display the
+  ranking symbol, the name and the score of the players on each
+  line of the LCD. Only the two shown are read from EEPROM, when
+  the list is scrolled; nothing is shown while it is written.
 */
-void displayHighscores(LiquidCrystal &lcd, char playerNames[maximumHighscores][playerNameSize], const unsigned long scores[], int maxPlayers, int menuIndex, int arrowLinePosition) {
+void displayHighscores(LiquidCrystal &lcd, int maxPlayers, int menuIndex, int arrowLinePosition) {
+  if (!highscoresPage.load(menuIndex)) {
+    return;
+  }
+
   lcd.setCursor(0, arrowLinePosition);
   lcd.write(arrowIndex);
 
@@ -217,14 +244,14 @@ void displayHighscores(LiquidCrystal &lcd, char playerNames[maximumHighscores][p
       lcd.setCursor(2, i);
       lcd.print(menuIndex + i + 1);
 
-      displayPlayerAndScore(lcd, playerNames[menuIndex + i], scores[menuIndex + i], i);
+      displayPlayerAndScore(lcd, highscoresPage.playerNames[i], highscoresPage.scores[i], i);
     }
   } else {
       // display the symbol for the podium
       lcd.setCursor(2, 0);
       lcd.print(menuIndex + 1);
 
-      displayPlayerAndScore(lcd, playerNames[menuIndex], scores[menuIndex], 0);
+      displayPlayerAndScore(lcd, highscoresPage.playerNames[0], highscoresPage.scores[0], 0);
 
       lcd.setCursor(2, 1);
       lcd.print("Back");
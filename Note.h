@@ -2,103 +2,62 @@
 #ifndef NOTE_H
 #define NOTE_H
 
-#include <LedControl.h>
-#include "Player.h"
+#include "Platform.h"
+#include "GameRandom.h"
 #include "Rooms.h"
-#include "ConstantsBlinking.h"
 
 struct Note{
   byte row;
   byte column;
   byte currentRoom;
 
-  // controls the note's visibility
-  bool isDisplayed;
-  // last time when isDisplayed changes its states, in ms
-  unsigned long lastDisplayBlinking;
-
-  Note(){
-    spawnNoteRandomly();
-  }
+  Note(): row(0), column(0), currentRoom(0) {}
 
   // functions to spawn the note
-  void spawnNoteRandomly();
-  void spawnNoteDifferentRoom(const byte playerRoom);
+  void spawnNoteRandomly(GameRandom &random);
+  void spawnNoteDifferentRoom(GameRandom &random, const byte playerRoom);
 
   // function to generate a random position in a room
-  void spawnInRoom();
-
-  // function to display the note in the room
-  void display(LedControl &lc, Player player);
+  void spawnInRoom(GameRandom &random);
 };
 
 /*
   Spawn a note in a random room,
   in a random, but valid position in that room.
 */
-void Note::spawnNoteRandomly(){
-  currentRoom = random(0, roomsSize);  
-  spawnInRoom();
+void Note::spawnNoteRandomly(GameRandom &random){
+  currentRoom = random.below(roomsSize);  
+  spawnInRoom(random);
 };
 
 /*
   Spawn the note in a different room
   from the room the player is currently in.
 */
-void Note::spawnNoteDifferentRoom(const byte playerRoom){
-  currentRoom = random(0, roomsSize);
+void Note::spawnNoteDifferentRoom(GameRandom &random, const byte playerRoom){
+  currentRoom = random.below(roomsSize);
 
   while (currentRoom == playerRoom) {
-    currentRoom = random(0, roomsSize);
+    currentRoom = random.below(roomsSize);
   }
 
-  spawnInRoom();
+  spawnInRoom(random);
 };
 
 /*
   Generate a position in the currentRoom
   until it is a valid one. Spawn that note in the position.
 */
-void Note::spawnInRoom(){
-  row = random(0, matrixSize);
-  column = random(0, matrixSize);
+void Note::spawnInRoom(GameRandom &random){
+  row = random.below(matrixSize);
+  column = random.below(matrixSize);
 
   // while the position generated is invalid,
   // generate new positions and check their validity
   while (rooms[currentRoom][row][column] == true){
-    row = random(0, matrixSize);
-    column = random(0, matrixSize);
-  }
-};
-
-/*
-  Display the current position of the note 
-  in the room. 
-  
-  It is visible for 500 ms and invisible for 100,
-  to make a blinking effect that is not similar with the blinking effect
-  of the player. 
-*/
-void Note::display(LedControl &lc, Player player){
-  // if the note and the player are placed in different rooms, exit
-  if (currentRoom != player.currentRoom)
-    return;
-
-  // depending on the state of the note,
-  // check if the state should be toggled 
-  if (isDisplayed) {
-    if ((millis() - noteDoctorActiveBlinkingInterval) > lastDisplayBlinking) {
-      lastDisplayBlinking = millis();
-      isDisplayed = !isDisplayed;
-      lc.setLed(0, row, column, isDisplayed);
-    }
-  } else {
-    if ((millis() - noteDoctorInactiveBlinkingInterval) > lastDisplayBlinking) {
-      lastDisplayBlinking = millis();
-      isDisplayed = !isDisplayed;
-      lc.setLed(0, row, column, isDisplayed);
-    }
+    row = random.below(matrixSize);
+    column = random.below(matrixSize);
   }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef PAR_TIMES_H
+#define PAR_TIMES_H
+
+#include "Platform.h"
+
+/*
+  Seeds the board picks its games from, each with the
+  fastest possible escape for it, in ms of game time.
+
+  Generated by tools/ParSolver.cpp, do not edit by hand.
+  One move every 150 ms, game stepped every 10 ms.
+*/
+
+struct ParSeed{
+  uint32_t seed;
+  uint32_t parTime;
+};
+
+const ParSeed parSeeds[] PROGMEM = {
+  {0x89025CC1UL, 12010UL},
+  {0x658EEC67UL, 10360UL},
+  {0xFB32555EUL, 10060UL},
+  {0xEE42C90BUL, 9460UL},
+  {0xD101B5B9UL, 11860UL},
+  {0x90150280UL, 12610UL},
+  {0xD7363CA5UL, 8260UL},
+  {0x12278575UL, 10810UL},
+  {0x357E3DA8UL, 10960UL},
+  {0x74616796UL, 9310UL},
+  {0x01564F61UL, 10810UL},
+  {0x14CF8BFEUL, 10060UL},
+  {0x4BAA5DC0UL, 9760UL},
+  {0x90D7A28AUL, 11410UL},
+  {0x6F4C57A8UL, 10210UL},
+  {0xA5794A3BUL, 12760UL},
+  {0xB7FD0B63UL, 8860UL},
+  {0x572BAAF1UL, 9760UL},
+  {0x30AF89EEUL, 10210UL},
+  {0x73EF6508UL, 9460UL},
+  {0x65E98746UL, 13360UL},
+  {0x5C2A449CUL, 11110UL},
+  {0xD1548FCDUL, 8710UL},
+  {0x3EF306ACUL, 10810UL},
+  {0xD1AAB99FUL, 10210UL},
+  {0xC177B6F7UL, 12760UL},
+  {0x864A7135UL, 9160UL},
+  {0x0D2DF7ABUL, 11710UL},
+  {0x445BCD27UL, 8110UL},
+  {0x1909778AUL, 6760UL},
+  {0x12C5D084UL, 10660UL},
+  {0xC90789BAUL, 11410UL},
+  {0x5A072C6DUL, 8410UL},
+  {0x48DCE01CUL, 10660UL},
+  {0x2EF3FC17UL, 10210UL},
+  {0x56FEFF0CUL, 10960UL},
+  {0x5E4BE0F5UL, 13360UL},
+  {0x003553C1UL, 10960UL},
+  {0x96EB9D18UL, 11260UL},
+  {0xBE5B133CUL, 10810UL},
+  {0x607E2C86UL, 12010UL},
+  {0x881E2907UL, 10510UL},
+  {0x59108163UL, 11860UL},
+  {0x8687FFB2UL, 12310UL},
+  {0x9FC66081UL, 10810UL},
+  {0x12C87E38UL, 10210UL},
+  {0x18E9685EUL, 9910UL},
+  {0x304D9F96UL, 11560UL},
+  {0x21373073UL, 10810UL},
+  {0x61EDD57AUL, 10960UL},
+  {0x77BA0574UL, 10510UL},
+  {0x4C4CBEE5UL, 10510UL},
+  {0xBD6AE8F8UL, 11860UL},
+  {0x29CA1790UL, 9910UL},
+  {0x0C5B4A8FUL, 11860UL},
+  {0x2751ECAFUL, 8860UL},
+  {0x9ACD7AAFUL, 13510UL},
+  {0xC8C694CCUL, 11410UL},
+  {0xBFF06252UL, 11710UL},
+  {0x5A4DC852UL, 11560UL},
+  {0x5CE2CE14UL, 10060UL},
+  {0x1075B77FUL, 10960UL},
+  {0x7914FFBCUL, 6460UL},
+  {0x401ED25BUL, 12910UL},
+};
+
+const byte parSeedsSize = 64;
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#ifndef PITCH_TABLE_H
+#define PITCH_TABLE_H
+
+#include "Platform.h"
+#include "pitches.h"
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+// Timer2 runs the buzzer's PWM in phase correct mode without a
+// prescaler, at F_CPU / 510 Hz, and every synthOversampling-th
+// period of it makes a new sample of the synthesizer
+const byte synthOversampling = 4;
+const unsigned long synthSampleRate = F_CPU / 510 / synthOversampling;
+
+/*
+  A pitch the synthesizer can play: the step its 16 bit phase
+  accumulator makes at every sample, so a whole turn of it, one
+  period of the note, takes synthSampleRate / frequency samples.
+*/
+struct Pitch{
+  int frequency;
+  unsigned int step;
+
+  constexpr Pitch(int frequency, unsigned int step): frequency(frequency), step(step) {}
+};
+
+// the step of the frequency, rounded; REST does not move
+constexpr Pitch pitchOf(int frequency){
+  return Pitch(frequency, (unsigned int) ((65536UL * frequency + synthSampleRate / 2) / synthSampleRate));
+}
+
+/*
+  Every pitch the songs use, computed when the sketch is
+  compiled; the songs keep the index of their pitches in it.
+*/
+constexpr Pitch pitches[] PROGMEM = {
+  pitchOf(REST),
+  pitchOf(NOTE_C2), pitchOf(NOTE_D2), pitchOf(NOTE_E2), pitchOf(NOTE_G2), pitchOf(NOTE_A2),
+  pitchOf(NOTE_D4), pitchOf(NOTE_DS4), pitchOf(NOTE_F4), pitchOf(NOTE_G4), pitchOf(NOTE_GS4),
+  pitchOf(NOTE_A4), pitchOf(NOTE_AS4),
+  pitchOf(NOTE_G5), pitchOf(NOTE_B5), pitchOf(NOTE_D6),
+};
+const byte pitchesSize = sizeof(pitches) / sizeof(pitches[0]);
+
+/*
+  Index of the frequency in pitches, found while compiling;
+  the frequencies missing from it are played as rests.
+*/
+constexpr byte pitch(int frequency, byte index = 0){
+  return index >= pitchesSize ? 0
+       : pitches[index].frequency == frequency ? index
+       : pitch(frequency, index + 1);
+}
+
+#endif
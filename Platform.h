@@ -0,0 +1,42 @@
+#pragma once
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+/*
+  The game rules are shared between the sketch and the
+  host tools, so they only rely on the fixed width types.
+  On the board they come from the Arduino core, on the
+  host they are defined here.
+*/
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+typedef uint8_t byte;
+
+// the host has no separate flash, the tables stay in RAM; the
+// words are copied out, as the tables are not all of that type
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *) (address))
+#define pgm_read_word(address) hostReadWord(address)
+#define pgm_read_dword(address) hostReadDword(address)
+
+inline uint16_t hostReadWord(const void *address){
+  uint16_t value;
+  memcpy(&value, address, sizeof(value));
+  return value;
+}
+
+inline uint32_t hostReadDword(const void *address){
+  uint32_t value;
+  memcpy(&value, address, sizeof(value));
+  return value;
+}
+#endif
+
+// keeps the compiler from moving memory accesses across it,
+// for the data shared between an interrupt and the loop
+#define compilerBarrier() __asm__ __volatile__("" ::: "memory")
+
+#endif
@@ -2,15 +2,11 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
-#include <LedControl.h>
-#include <LiquidCrystal.h>
-
-#include "JoyStick.h"
+#include "Platform.h"
+#include "Directions.h"
+#include "GameRandom.h"
 #include "Rooms.h"
 
-// interval in ms between player's blinking position 
-const byte playerBlinkingInterval = 50;
-
 struct Player{
   byte row;
   byte column;
@@ -19,59 +15,59 @@ struct Player{
   byte notes;
   byte lives;
 
-  // controls the player's visibility
-  bool isDisplayed;
   // controls the winning state of the player
   bool isWinning;
   // controls if the player had a highscore
   bool hasHighscore;
   bool hasUserName;
-  // last time when isDisplayed changed its state, in ms
-  unsigned long lastDisplayBlinking;
 
-  Player(LedControl &lc){
-    reset(lc);
+  Player(){
+    row = 1;
+    column = 1;
+    currentRoom = 0;
+
+    notes = 0;
+    lives = 3;
+
+    isWinning = false;
+    hasHighscore = false;
+    hasUserName = false;
   };
 
   // functions to handle player's movement
-  void movementWatcher(LedControl &lc, Joystick &joystick);
-  void movementUpHandler(LedControl &lc);
-  void movementDownHandler(LedControl &lc);
-  void movementLeftHandler(LedControl &lc);
-  void movementRightHandler(LedControl &lc);
-
-  // function to display the player in the room
-  void display(LedControl &lc);
-  void displayNotes(LiquidCrystal &lcd);
-  void displayLives(LiquidCrystal &lcd, byte heartsStartPosition, const int line);
+  void movementWatcher(const byte direction);
+  void movementUpHandler();
+  void movementDownHandler();
+  void movementLeftHandler();
+  void movementRightHandler();
 
   // function to initate the players position;
-  void reset(LedControl &lc);
+  void reset(GameRandom &random);
 };
 
 /*
-  Listens to the joystick movement, and
-  depending on the direction, handles that movement.
+  Listens to the joystick direction, and
+  depending on it, handles that movement.
 */
-void Player::movementWatcher(LedControl &lc, Joystick &joystick){
-  if (joystick.direction == joystickUp) {
-    movementUpHandler(lc);
+void Player::movementWatcher(const byte direction){
+  if (direction == joystickUp) {
+    movementUpHandler();
   }
 
-  if (joystick.direction == joystickDown) {
-    movementDownHandler(lc);
+  if (direction == joystickDown) {
+    movementDownHandler();
   }
 
-  if (joystick.direction == joystickLeft) {
-    movementLeftHandler(lc);
+  if (direction == joystickLeft) {
+    movementLeftHandler();
   }
 
-  if (joystick.direction == joystickRight) {
-    movementRightHandler(lc);
+  if (direction == joystickRight) {
+    movementRightHandler();
   }
 };
 
-void Player::movementUpHandler(LedControl &lc){
+void Player::movementUpHandler(){
   if (row > 0) {
     // if the player moves into a wall, 
     // ignore the movement
@@ -79,8 +75,6 @@ void Player::movementUpHandler(LedControl &lc){
       return;
     }
 
-    // otherwise, unset the current position
-    lc.setLed(0, row, column, false);
     // move up
     row -= 1;
   } 
@@ -90,7 +84,6 @@ void Player::movementUpHandler(LedControl &lc){
     // move to the next room according to 
     // the movement matrix
     currentRoom = roomsCommunication[currentRoom][joystickUp];
-    setRoom(lc, currentRoom);
 
     // if the player moved up through a door, that means
     // it is now currently on the last row of the new room
@@ -98,7 +91,7 @@ void Player::movementUpHandler(LedControl &lc){
   }
 };
 
-void Player::movementDownHandler(LedControl &lc){
+void Player::movementDownHandler(){
   if (row < matrixSize - 1) {
     // if the player moves into a wall, 
     // ignore the movement
@@ -106,8 +99,6 @@ void Player::movementDownHandler(LedControl &lc){
       return;
     }
 
-    // otherwise, unset the current position
-    lc.setLed(0, row, column, false);
     // move down
     row += 1;
   } 
@@ -118,7 +109,6 @@ void Player::movementDownHandler(LedControl &lc){
     // move to the next room according to 
     // the movement matrix
     currentRoom = roomsCommunication[currentRoom][joystickDown];
-    setRoom(lc, currentRoom);
     
     // if the player moved down through a door, that means
     // it is now currently on the first row of the new room
@@ -126,7 +116,7 @@ void Player::movementDownHandler(LedControl &lc){
   }
 };
 
-void Player::movementLeftHandler(LedControl &lc){
+void Player::movementLeftHandler(){
   if (column > 0) {
     // if the player moves into a wall, 
     // ignore the movement
@@ -134,8 +124,6 @@ void Player::movementLeftHandler(LedControl &lc){
       return;
     }
     
-    // otherwise, unset the current position
-    lc.setLed(0, row, column, false);
     // move to the left
     column -= 1;
   } 
@@ -145,7 +133,6 @@ void Player::movementLeftHandler(LedControl &lc){
     // move to the next room according to 
     // the movement matrix
     currentRoom = roomsCommunication[currentRoom][joystickLeft];
-    setRoom(lc, currentRoom);
   
     // if the player moved to the left through a door, that means
     // it is now currently on the last column of the new room
@@ -153,7 +140,7 @@ void Player::movementLeftHandler(LedControl &lc){
   }
 };
 
-void Player::movementRightHandler(LedControl &lc){
+void Player::movementRightHandler(){
   if (column < matrixSize - 1) {
     // if the player moves into a wall, 
     // ignore the movement
@@ -161,8 +148,6 @@ void Player::movementRightHandler(LedControl &lc){
       return;
     }
 
-    // otherwise, unset the current position
-    lc.setLed(0, row, column, false);
     // move to the right
     column += 1;
   } 
@@ -173,7 +158,6 @@ void Player::movementRightHandler(LedControl &lc){
     // move to the next room according to 
     // the movement matrix
     currentRoom = roomsCommunication[currentRoom][joystickRight];
-    setRoom(lc, currentRoom);
 
     // if the player moved to the right through a door, that means
     // it is now currently on the first column of the new room
@@ -181,54 +165,21 @@ void Player::movementRightHandler(LedControl &lc){
   }
 };
 
-/*
-  Display the current position of the player in
-  a blinking mode. Once 50 ms. make the player blink
-  so it is easily distinguishable.
-*/
-void Player::display(LedControl &lc){
-  if ((millis() - lastDisplayBlinking) > playerBlinkingInterval) {
-    lastDisplayBlinking = millis();
-    isDisplayed = !isDisplayed;
-    lc.setLed(0, row, column, isDisplayed);
-  }
-};
-
-void Player::displayNotes(LiquidCrystal &lcd){
-  lcd.setCursor(0, 1);
-  lcd.print("Notes:");
-
-  // 7 is the length of "Notes "
-  lcd.setCursor(7, 1);
-  lcd.print(notes);
-};
-
-void Player::displayLives(LiquidCrystal &lcd, byte heartsStartPosition, const int line){
-  for(int i = 0; i < lives; i++) {
-    lcd.setCursor(heartsStartPosition + i, line);
-    lcd.write(heartIndex);
-  }
-};
-
-void Player::reset(LedControl &lc){
-      // start from position 1, 1 in the room
+void Player::reset(GameRandom &random){
+    // start from position 1, 1 in the room
     row = 1;
     column = 1;
     
     notes = 0;
     lives = 3;
 
-    // choose the room randomly and  
-    // display the room on the matrix
-    currentRoom = random(0, roomsSize);
-    setRoom(lc, currentRoom);
+    // choose the room randomly
+    currentRoom = random.below(roomsSize);
 
     // the player starts from a losing state
     isWinning = false;
-    // the player is being displayed on the matrix
-    isDisplayed = true;
     // the player needs to earn the highscores, so its false at start
     hasHighscore = false;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -2,6 +2,9 @@
 #ifndef ROOMS_H
 #define ROOMS_H
 
+#include "Platform.h"
+#include "Directions.h"
+
 const byte directions = 4;
 const byte roomsSize = 4;
 const byte matrixSize = 8;
@@ -69,38 +72,4 @@ const byte roomsCommunication[roomsSize][directions] = {
   {1, 1, 2, 2}    // room 3
 };
 
-/*
-  Given one of the rooms, display it
-*/
-void setRoom(LedControl &lc, int room){
-  for (int row = 0; row < matrixSize; row++) {
-    for (int col = 0; col < matrixSize; col++) {
-      lc.setLed(0, row, col, rooms[room][row][col]);
-    }
-  }
-};
-
-
-/*
-  Light up the whole matrix.
-*/
-void setCompleteMatrix(LedControl &lc){
-  for (int row = 0; row < matrixSize; row++) {
-    for (int col = 0; col < matrixSize; col++) {
-      lc.setLed(0, row, col, true);
-    }
-  }
-};
-
-/*
-  Reset the matrix values
-*/
-void resetMatrix(LedControl &lc){
-  for (int row = 0; row < matrixSize; row++) {
-    for (int col = 0; col < matrixSize; col++) {
-      lc.setLed(0, row, col, false);
-    }
-  }
-};
-
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef ROOMS_DISPLAY_H
+#define ROOMS_DISPLAY_H
+
+#include <LedControl.h>
+
+#include "Rooms.h"
+#include "Job.h"
+
+/*
+  Display one row of the given room.
+*/
+void setRoomRow(LedControl &lc, int room, int row){
+  for (int col = 0; col < matrixSize; col++) {
+    lc.setLed(0, row, col, rooms[room][row][col]);
+  }
+};
+
+/*
+  Given one of the rooms, display it
+*/
+void setRoom(LedControl &lc, int room){
+  for (int row = 0; row < matrixSize; row++) {
+    setRoomRow(lc, room, row);
+  }
+};
+
+/*
+  Draws a room on the matrix a row at a time, so
+  walking through a door does not hold up the loop.
+*/
+struct RoomDrawing{
+  Job job;
+  LedControl *lc;
+  byte room;
+  // next row to draw
+  byte row;
+
+  RoomDrawing(): job("room", 500), lc(NULL), room(0), row(0) {}
+
+  void start(LedControl &lc, byte room);
+  byte advance();
+};
+
+RoomDrawing roomDrawing;
+
+void RoomDrawing::start(LedControl &lc, byte room){
+  this->lc = &lc;
+  this->room = room;
+  row = 0;
+
+  job.start();
+}
+
+byte RoomDrawing::advance(){
+  setRoomRow(*lc, room, row);
+  row += 1;
+
+  return row < matrixSize ? jobWorking : jobDone;
+}
+
+
+/*
+  Light up the whole matrix.
+*/
+void setCompleteMatrix(LedControl &lc){
+  // a room still being drawn would cover it
+  roomDrawing.job.cancel();
+
+  for (int row = 0; row < matrixSize; row++) {
+    for (int col = 0; col < matrixSize; col++) {
+      lc.setLed(0, row, col, true);
+    }
+  }
+};
+
+/*
+  Reset the matrix values
+*/
+void resetMatrix(LedControl &lc){
+  roomDrawing.job.cancel();
+
+  for (int row = 0; row < matrixSize; row++) {
+    for (int col = 0; col < matrixSize; col++) {
+      lc.setLed(0, row, col, false);
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,134 @@
+#pragma once
+#ifndef SAVED_GAME_H
+#define SAVED_GAME_H
+
+#include "EEPROM.h"
+
+#include "EepromWriter.h"
+#include "Snapshot.h"
+#include "Store.h"
+
+// the saved games take the EEPROM after the store, up to
+// its end: every slot holds a sequence number, then a snapshot
+const int savedGameStartAddr = storeEndAddr;
+const byte savedGameSlots = 32;
+const byte savedGameSlotSize = 1 + snapshotSize;
+
+static_assert(savedGameStartAddr + savedGameSlots * savedGameSlotSize <= 1024,
+              "the saved games run past the end of the EEPROM");
+
+/*
+  The game is saved at every pause, note and death, so the
+  snapshots go around the slots: every save is written to the
+  slot after the newest one, and a cell is only written once
+  every savedGameSlots saves. The sequence numbers go up by one
+  from slot to slot, so the newest snapshot is the one whose
+  next slot holds an older number. Its sequence number is
+  written last, so a save cut by a power loss leaves the one
+  before as the newest.
+
+  The snapshot being written in the background, and the
+  newest one, which waits for it to be written.
+*/
+struct SavedGameWriting{
+  GameSnapshot writing;
+  GameSnapshot pending;
+  bool hasPending;
+  // slot and sequence number of the newest snapshot,
+  // or of the one being written
+  byte slot;
+  byte sequence;
+  // the snapshot, then the sequence number
+  EepromRequest snapshotRequest;
+  EepromRequest sequenceRequest;
+
+  SavedGameWriting(): hasPending(false), slot(0), sequence(0) {}
+
+  void update();
+};
+
+SavedGameWriting savedGameWriting;
+
+// the first byte of the snapshot, as written to forget it
+const byte savedGameCleared = 0;
+EepromRequest savedGameClearing;
+
+int savedGameSlotAddr(byte slot){
+  return savedGameStartAddr + slot * savedGameSlotSize;
+}
+
+/*
+  Find the slot of the newest snapshot, at boot.
+*/
+void loadSavedGames(){
+  eepromWriter.flush();
+
+  byte slot = 0;
+  byte sequence = EEPROM.read(savedGameSlotAddr(0));
+
+  while (slot + 1 < savedGameSlots && EEPROM.read(savedGameSlotAddr(slot + 1)) == (byte) (sequence + 1)) {
+    slot += 1;
+    sequence += 1;
+  }
+
+  savedGameWriting.slot = slot;
+  savedGameWriting.sequence = sequence;
+}
+
+/*
+  Start writing the pending snapshot, in the next slot, once
+  the last one is written: the snapshot first, then the
+  sequence number, which makes it the newest one.
+*/
+void SavedGameWriting::update(){
+  if (!hasPending || !sequenceRequest.isDone || !savedGameClearing.isDone || eepromWriter.freeSpace() < 2) {
+    return;
+  }
+
+  writing = pending;
+  slot = slot + 1 < savedGameSlots ? slot + 1 : 0;
+  sequence += 1;
+
+  int address = savedGameSlotAddr(slot);
+  eepromWriter.write(snapshotRequest, address + 1, writing.bytes, snapshotSize);
+  eepromWriter.write(sequenceRequest, address, &sequence, 1);
+  hasPending = false;
+};
+
+/*
+  Read the newest saved game from EEPROM.
+  Returns false if there is no valid one.
+*/
+bool readSavedGame(GameSnapshot &snapshot){
+  eepromWriter.flush();
+
+  int address = savedGameSlotAddr(savedGameWriting.slot) + 1;
+  for (byte i = 0; i < snapshotSize; i++) {
+    snapshot.bytes[i] = EEPROM.read(address + i);
+  }
+
+  return snapshot.isValid();
+};
+
+/*
+  Write the snapshot to EEPROM, in the background.
+*/
+void writeSavedGame(const GameSnapshot &snapshot){
+  savedGameWriting.pending = snapshot;
+  savedGameWriting.hasPending = true;
+  savedGameWriting.update();
+};
+
+/*
+  Forget the saved game; changing the version byte of
+  the newest snapshot is enough to make it invalid.
+*/
+void clearSavedGame(){
+  savedGameWriting.hasPending = false;
+
+  if (savedGameClearing.isDone) {
+    eepromWriter.write(savedGameClearing, savedGameSlotAddr(savedGameWriting.slot) + 1, &savedGameCleared, 1);
+  }
+};
+
+#endif
@@ -0,0 +1,175 @@
+#pragma once
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "Log.h"
+
+/*
+  Cooperative scheduler for the loop: a static table of tasks,
+  each one run when it is due, every period ms (or once, for
+  the tasks with period 0), with the time of the current tick.
+
+  On the board, the tick comes from Timer0's compare match A
+  interrupt, which fires with every overflow of the timer, like
+  the one that drives millis(): every 1.024 ms, not every ms.
+  The tick only wakes the loop up, its time is read from millis(),
+  which makes up for the 24 µs by moving on 2 ms about every 42
+  ticks; the tasks are due by comparing that time with theirs, so
+  none is skipped then. The loops between two ticks do nothing.
+  Elsewhere, a tick is every change of millis().
+*/
+
+// ms millis() can move on by between two ticks, without the
+// loop being late: it makes up for the 1.024 ms of a tick
+const byte schedulerTickJitter = 1;
+
+// time of the current tick, in ms; everything run by the
+// scheduler reads it, instead of calling millis() again
+unsigned long tickNow = 0;
+
+struct Task{
+  const char *name;
+  void (*run)(unsigned long now);
+  // time between two runs, in ms; 0 for the tasks run once
+  unsigned long period;
+  unsigned long nextRun;
+  bool isEnabled;
+
+  unsigned long runs;
+  // runs that were late by at least a whole period
+  unsigned int overruns;
+  // longest run, in µs
+  unsigned long longestRun;
+
+  Task(const char *name, void (*run)(unsigned long now), unsigned long period):
+    name(name), run(run), period(period), nextRun(0), isEnabled(period > 0),
+    runs(0), overruns(0), longestRun(0) {}
+};
+
+#ifdef __AVR__
+
+volatile byte pendingTicks = 0;
+
+ISR(TIMER0_COMPA_vect){
+  pendingTicks += 1;
+}
+
+#endif
+
+struct Scheduler{
+  Task *tasks;
+  byte tasksSize;
+
+  Scheduler(Task tasks[], byte tasksSize): tasks(tasks), tasksSize(tasksSize) {}
+
+  void begin();
+  bool tick();
+  bool run();
+  void runAfter(byte task, unsigned long delay);
+  void printStatistics();
+};
+
+/*
+  Start the tick: Timer0 already counts for millis(), so only
+  its compare match A interrupt needs to be turned on; it fires
+  halfway between two overflows, every 1.024 ms.
+*/
+void Scheduler::begin(){
+#ifdef __AVR__
+  OCR0A = 0x80;
+  TIMSK0 |= (1 << OCIE0A);
+#endif
+
+  tickNow = millis();
+  for (byte i = 0; i < tasksSize; i++) {
+    tasks[i].nextRun = tickNow + tasks[i].period;
+  }
+}
+
+/*
+  Returns true if a new tick started, taking its time.
+*/
+bool Scheduler::tick(){
+#ifdef __AVR__
+  noInterrupts();
+  byte ticks = pendingTicks;
+  pendingTicks = 0;
+  interrupts();
+
+  if (ticks == 0) {
+    return false;
+  }
+#else
+  if (millis() == tickNow) {
+    return false;
+  }
+#endif
+
+  tickNow = millis();
+  return true;
+}
+
+/*
+  Run the tasks that are due in this tick. A task that is late
+  by a whole period or more runs only once, it does not try to
+  catch up with the runs it missed; it counts an overrun, unless
+  it is only late by the ms millis() skips now and then.
+  Returns false if there was no new tick to run.
+*/
+bool Scheduler::run(){
+  if (!tick()) {
+    return false;
+  }
+
+  for (byte i = 0; i < tasksSize; i++) {
+    Task &task = tasks[i];
+
+    if (!task.isEnabled || (long) (tickNow - task.nextRun) < 0) {
+      continue;
+    }
+
+    if (task.period > 0 && tickNow - task.nextRun >= task.period) {
+      // millis() moving on by 2 ms is not the task's fault
+      if (tickNow - task.nextRun >= task.period + schedulerTickJitter) {
+        task.overruns += 1;
+      }
+      task.nextRun = tickNow;
+    }
+
+    unsigned long start = micros();
+    task.run(tickNow);
+    unsigned long duration = micros() - start;
+
+    task.runs += 1;
+    if (duration > task.longestRun) {
+      task.longestRun = duration;
+    }
+
+    if (task.period > 0) {
+      task.nextRun += task.period;
+    } else {
+      task.isEnabled = false;
+    }
+  }
+
+  return true;
+}
+
+/*
+  Run the given task once, after the delay.
+*/
+void Scheduler::runAfter(byte task, unsigned long delay){
+  tasks[task].nextRun = tickNow + delay;
+  tasks[task].isEnabled = true;
+}
+
+/*
+  Log the runs, overruns and longest run of every task.
+*/
+void Scheduler::printStatistics(){
+  for (byte i = 0; i < tasksSize; i++) {
+    LOG_INFO(logTaskStatistics, tasks[i].name, tasks[i].runs, tasks[i].overruns, tasks[i].longestRun);
+  }
+}
+
+#endif
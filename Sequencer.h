@@ -0,0 +1,246 @@
+#pragma once
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include "Platform.h"
+#include "Song.h"
+#include "Synth.h"
+
+// the tempos are in Q8 fixed point: the notes last tempo / 256
+// of their written duration, so 256 plays them as written
+const unsigned int sequencerNormalTempo = 256;
+// silence after every note, in Q8 of the note (0.3)
+const byte sequencerGap = 77;
+
+/*
+  One song being played: where it got to in the song,
+  and how long until its next note.
+*/
+struct Channel{
+  // the song playing, in flash, or NULL
+  const byte *song;
+  SongReader reader;
+  // Q8 part of the written durations the notes last
+  unsigned int tempo;
+  // the song starts again once it is over
+  bool isLooping;
+
+  // pitch of the current note, 0 during the gap after it
+  byte pitch;
+  // ms left of the current note, or of the gap after it
+  unsigned int remaining;
+  // silence left to keep after the current note, in ms
+  unsigned int gap;
+
+  Channel(): song(NULL), tempo(sequencerNormalTempo), isLooping(false), pitch(0), remaining(0), gap(0) {}
+
+  void start(const byte song[], unsigned int tempo, bool isLooping);
+  void stop();
+  bool tick();
+  void startNote();
+};
+
+void Channel::start(const byte song[], unsigned int tempo, bool isLooping){
+  this->song = song;
+  this->tempo = tempo;
+  this->isLooping = isLooping;
+
+  reader.begin(song);
+  startNote();
+}
+
+void Channel::stop(){
+  song = NULL;
+  pitch = 0;
+}
+
+/*
+  Move the channel forward by one ms.
+  Returns true if its pitch changed.
+*/
+bool Channel::tick(){
+  if (song == NULL) {
+    return false;
+  }
+
+  if (remaining > 1) {
+    remaining -= 1;
+    return false;
+  }
+
+  // the note is over, keep quiet for the gap after it
+  if (gap > 0) {
+    pitch = 0;
+    remaining = gap;
+    gap = 0;
+    return true;
+  }
+
+  startNote();
+  return true;
+}
+
+/*
+  Read the next note of the song and play it. At the end, a
+  looping song starts again, the others stop the channel.
+*/
+void Channel::startNote(){
+  unsigned int duration;
+
+  if (!reader.next(pitch, duration)) {
+    reader.begin(song);
+
+    // a song without notes is not played
+    if (!isLooping || !reader.next(pitch, duration)) {
+      stop();
+      return;
+    }
+  }
+
+  // only shifts, no division, as this runs in the interrupt
+  duration = ((unsigned long) duration * tempo) >> 8;
+
+  remaining = duration > 0 ? duration : 1;
+  gap = ((unsigned long) duration * sequencerGap) >> 8;
+}
+
+/*
+  Plays the songs on the buzzer in the background, on two
+  channels: the music, looping, and the sound effects, played
+  once. Every channel has its own voice of the synthesizer,
+  so an effect plays over the music.
+
+  On the board, the timer interrupt calls tick() once for every
+  ms, which moves the channels to their next note when the current
+  one is over and sets their voice to its pitch; the loop only says
+  what to play. Elsewhere, update() ticks it from the loop with the
+  time passed.
+
+  The loop changes the songs with the interrupts turned off,
+  so the interrupt always sees whole channels.
+*/
+struct Sequencer{
+  Channel music;
+  Channel effect;
+
+  unsigned long lastUpdate;
+
+  Sequencer(): lastUpdate(0) {}
+
+  void begin(byte buzzerPin);
+  void playMusic(const byte song[], unsigned int tempo);
+  void playEffect(const byte song[]);
+  void stop();
+  void tick();
+  void update(unsigned long now);
+};
+
+Sequencer sequencer;
+
+#ifdef __AVR__
+
+// Timer0's compare match B fires with every overflow, every 1.024
+// ms, like compare match A does for the scheduler but halfway
+// between two of its ticks. The 24 µs over a ms are added up, in
+// steps of 8 µs like millis() does, and give the songs an extra ms
+// about every 42 interrupts, so they play at their tempo.
+const byte sequencerFractionStep = 24 / 8;
+const byte sequencerFractionWhole = 1000 / 8;
+
+byte sequencerFraction = 0;
+
+ISR(TIMER0_COMPB_vect){
+  sequencer.tick();
+
+  sequencerFraction += sequencerFractionStep;
+  if (sequencerFraction >= sequencerFractionWhole) {
+    sequencerFraction -= sequencerFractionWhole;
+    sequencer.tick();
+  }
+}
+
+#endif
+
+/*
+  Start the synthesizer on the buzzer's pin,
+  and the sequencer's interrupt.
+*/
+void Sequencer::begin(byte buzzerPin){
+  startSynth(buzzerPin);
+
+#ifdef __AVR__
+  OCR0B = 0x00;
+  TIMSK0 |= (1 << OCIE0B);
+#endif
+
+  lastUpdate = millis();
+}
+
+/*
+  Play the song as music from its first note, unless it is the one
+  already playing; then only the tempo changes, from the next note on.
+*/
+void Sequencer::playMusic(const byte song[], unsigned int tempo){
+  noInterrupts();
+
+  if (music.song != song) {
+    music.start(song, tempo, true);
+    setVoice(0, music.pitch);
+  } else {
+    music.tempo = tempo;
+  }
+
+  interrupts();
+}
+
+/*
+  Play the effect once, over the music; an effect
+  already playing is cut short by the new one.
+*/
+void Sequencer::playEffect(const byte song[]){
+  noInterrupts();
+
+  effect.start(song, sequencerNormalTempo, false);
+  setVoice(1, effect.pitch);
+
+  interrupts();
+}
+
+void Sequencer::stop(){
+  noInterrupts();
+
+  music.stop();
+  effect.stop();
+  setVoice(0, 0);
+  setVoice(1, 0);
+
+  interrupts();
+}
+
+/*
+  Move the songs forward by one ms. Runs in the interrupt.
+*/
+void Sequencer::tick(){
+  if (music.tick()) {
+    setVoice(0, music.pitch);
+  }
+
+  if (effect.tick()) {
+    setVoice(1, effect.pitch);
+  }
+}
+
+/*
+  Tick the sequencer for the time passed since the last update.
+  The board's interrupt already does it, so there it does nothing.
+*/
+void Sequencer::update(unsigned long now){
+#ifndef __AVR__
+  while (lastUpdate != now) {
+    lastUpdate += 1;
+    tick();
+  }
+#endif
+}
+
+#endif
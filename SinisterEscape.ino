@@ -64,9 +64,14 @@
 */
 
 #include "CustomCharacters.h"
-#include "Joystick.h"
+#include "JoyStick.h"
 #include "Menu.h"
 #include "Game.h"
+#include "InputRecorder.h"
+#include "Scheduler.h"
+#include "LoopTiming.h"
+#include "Log.h"
+#include "Memory.h"
 
 // PINs connected to the matrix
 const byte dinPin = 13;
@@ -97,11 +102,47 @@ const byte brightnessPin = 10;
 
 Menu menu(lcdRS, lcdEN, lcdD4, lcdD5, lcdD6, lcdD7, dinPin, clockPin, loadPin, buzzerPin, brightnessPin);
 
+// the menus and the game are drawn about 60 times per second,
+// the game itself moves in its own steps of gameStepInterval
+const unsigned long menuTaskPeriod = 16;
+
+// tasks run by the scheduler, with their period in ms
+void joystickTask(unsigned long now);
+void menuTask(unsigned long now);
+void melodyTask(unsigned long now);
+void jobsTask(unsigned long now);
+void statisticsTask(unsigned long now);
+void logTask(unsigned long now);
+
+Task tasks[] = {
+  Task("joystick", joystickTask, 1),
+  Task("menu", menuTask, menuTaskPeriod),
+  Task("melody", melodyTask, 5),
+  Task("jobs", jobsTask, 1),
+  Task("statistics", statisticsTask, 60000),
+  Task("log", logTask, 10),
+};
+const byte tasksSize = sizeof(tasks) / sizeof(tasks[0]);
+
+Scheduler scheduler(tasks, tasksSize);
+
+// a loop running a tick should be done well before the next frame
+LoopTiming loopTiming(menuTaskPeriod * 1000UL);
+
 void setup() {
+  // so the statistics can tell how deep the stack went
+  paintMemory();
+
   // set up joystick's pins
   pinMode(joystickinSW, INPUT_PULLUP);
   pinMode(joystickinX, INPUT);
   pinMode(joystickinY, INPUT);
+
+  // set the seed for randomness from the noise of both
+  // axes, before the joystick takes the ADC over
+  uint32_t seed = analogRead(joystickinX) ^ ((uint32_t) analogRead(joystickinY) << 10) ^ micros();
+  boardRandom.seed(seed);
+  joystick.begin();
   
   // set brightness pin for LCD
   pinMode(brightnessPin, OUTPUT);
@@ -110,21 +151,95 @@ void setup() {
   // set up the LCD's number of columns and rows
   menu.lcd.begin(16, 2);
 
-  // set the buzzer pin
-  pinMode(buzzerPin, OUTPUT);
+  // load the settings and the highscores, checking the EEPROM's
+  // layout and migrating it first if it is an older one
+  unsigned long eepromStart = micros();
+  menu.begin();
+  unsigned long eepromTime = micros() - eepromStart;
 
-  // set the seed for randomness
-  randomSeed(analogRead(0));
+  // set the buzzer pin, played by the sequencer's interrupt
+  sequencer.begin(buzzerPin);
 
   Serial.begin(9600);
+  startInputRecording(seed);
+
+  scheduler.begin();
+
+  // the first frame is drawn by the menu's first tick, right after
+  unsigned long bootTime = micros();
+  if (bootTime > bootTimeBudget) {
+    LOG_WARNING(logBootTime, bootTime, eepromTime, bootTimeBudget);
+  } else {
+    LOG_INFO(logBootTime, bootTime, eepromTime, bootTimeBudget);
+  }
 }
 
 void loop() {
-  // constantly listens to joystick movements
+  unsigned long start = micros();
+
+  if (scheduler.run()) {
+    loopTiming.add(micros() - start);
+  }
+}
+
+/*
+  Watch the stick often, so a quick flick
+  is queued even if the menu is busy.
+*/
+void joystickTask(unsigned long now) {
+  joystick.directionWatcher(now);
+}
+
+/*
+  Handle the queued input, then update the menus and the game.
+*/
+void menuTask(unsigned long) {
   joystick.switchHandler();
   joystick.movementHandler();
+  recordInput(joystick);
  
   menu.menuSwitch(joystick);
 }
 
+/*
+  Pick the melody for the state of the game; its
+  notes are played by the sequencer's interrupt.
+*/
+void melodyTask(unsigned long now) {
+  menu.melodyHandler(now);
+}
+
+/*
+  Move the background jobs on by a slice each, and queue
+  the EEPROM writes that waited for the last ones.
+*/
+void jobsTask(unsigned long) {
+  runSlice(roomDrawing);
+
+  highscoresWriting.update();
+  store.update();
+  savedGameWriting.update();
+  eepromWriter.update();
+}
+
+void statisticsTask(unsigned long) {
+  scheduler.printStatistics();
+  loopTiming.printStatistics();
+  roomDrawing.job.printStatistics();
+  loopTiming.reset();
+
+  LOG_INFO(logMemoryStatistics, freeMemory(), unusedMemory());
+}
+
+/*
+  Hand the log records to the serial port, as much as it takes
+  without waiting; tools/LogDecoder.cpp turns them back into text.
+*/
+void logTask(unsigned long) {
+  // the serial port carries the recorded input
+  if (!isRecordingInput) {
+    logBuffer.drain();
+  }
+}
+
 
@@ -0,0 +1,169 @@
+#pragma once
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "Platform.h"
+#include "Crc8.h"
+#include "GameState.h"
+
+// bytes of a packed game
+const byte snapshotSize = 16;
+// first byte of a valid snapshot, changed whenever the layout changes
+const byte snapshotVersion = 1;
+
+// width in bits of the packed fields
+const byte snapshotRoomBits = 2;
+const byte snapshotPositionBits = 3;
+const byte snapshotNotesBits = 3;
+const byte snapshotLivesBits = 2;
+const byte snapshotTimeBits = 24;
+const byte snapshotCooldownBits = 11;
+const byte snapshotParSeedBits = 8;
+
+/*
+  Writes and reads values of any width, one bit after
+  the other, starting with the lowest bit of every value.
+*/
+struct BitPacker{
+  byte *bytes;
+  byte position;
+
+  BitPacker(byte *bytes, byte position): bytes(bytes), position(position) {}
+
+  void write(uint32_t value, byte bits);
+  uint32_t read(byte bits);
+};
+
+void BitPacker::write(uint32_t value, byte bits){
+  for (byte bit = 0; bit < bits; bit++, position++) {
+    byte mask = 1 << (position & 7);
+
+    if ((value >> bit) & 1) {
+      bytes[position >> 3] |= mask;
+    } else {
+      bytes[position >> 3] &= ~mask;
+    }
+  }
+}
+
+uint32_t BitPacker::read(byte bits){
+  uint32_t value = 0;
+
+  for (byte bit = 0; bit < bits; bit++, position++) {
+    if (bytes[position >> 3] & (1 << (position & 7))) {
+      value |= (uint32_t) 1 << bit;
+    }
+  }
+
+  return value;
+}
+
+/*
+  A running game packed in 16 bytes, so it can be saved
+  and continued after the board was turned off:
+
+  -> byte 0: snapshotVersion, anything else means no game
+  -> bytes 1 - 14, in bits: player room 2, row 3, column 3,
+     notes 3, lives 2; note room 2, row 3, column 3;
+     Dr. room 2, row 3, column 3, waiting 1, chasing 1,
+     ms since his last movement 11; game time in ms 24;
+     random generator 32; par seed 8
+  -> byte 15: CRC-8 of the other bytes
+
+  The level follows from the notes and the time in seconds
+  from the game time, so they are not stored.
+*/
+struct GameSnapshot{
+  byte bytes[snapshotSize];
+
+  void pack(const GameState &state, byte parSeed);
+  bool unpack(GameState &state, byte &parSeed) const;
+  bool isValid() const;
+};
+
+void GameSnapshot::pack(const GameState &state, byte parSeed){
+  bytes[0] = snapshotVersion;
+
+  BitPacker packer(bytes + 1, 0);
+
+  packer.write(state.player.currentRoom, snapshotRoomBits);
+  packer.write(state.player.row, snapshotPositionBits);
+  packer.write(state.player.column, snapshotPositionBits);
+  packer.write(state.player.notes, snapshotNotesBits);
+  packer.write(state.player.lives, snapshotLivesBits);
+
+  packer.write(state.note.currentRoom, snapshotRoomBits);
+  packer.write(state.note.row, snapshotPositionBits);
+  packer.write(state.note.column, snapshotPositionBits);
+
+  packer.write(state.doctor.currentRoom, snapshotRoomBits);
+  packer.write(state.doctor.row, snapshotPositionBits);
+  packer.write(state.doctor.column, snapshotPositionBits);
+  packer.write(state.doctor.isWaiting, 1);
+  packer.write(state.doctor.isChasing, 1);
+
+  // the cooldowns are shorter than 2 s, so a longer
+  // wait than that behaves just like 2 s
+  unsigned long sinceMovement = state.now - state.doctor.lastMovement;
+  const unsigned long maximumCooldown = (1UL << snapshotCooldownBits) - 1;
+  packer.write(sinceMovement < maximumCooldown ? sinceMovement : maximumCooldown, snapshotCooldownBits);
+
+  const unsigned long maximumTime = (1UL << snapshotTimeBits) - 1;
+  packer.write(state.now < maximumTime ? state.now : maximumTime, snapshotTimeBits);
+
+  packer.write(state.random.state, 32);
+  packer.write(parSeed, snapshotParSeedBits);
+
+  bytes[snapshotSize - 1] = crc8(bytes, snapshotSize - 1);
+}
+
+bool GameSnapshot::isValid() const{
+  return bytes[0] == snapshotVersion && bytes[snapshotSize - 1] == crc8(bytes, snapshotSize - 1);
+}
+
+/*
+  Restore the game saved in the snapshot, paused. Returns
+  false, without touching the state, if there is no valid game.
+*/
+bool GameSnapshot::unpack(GameState &state, byte &parSeed) const{
+  if (!isValid()) {
+    return false;
+  }
+
+  BitPacker packer((byte *) bytes + 1, 0);
+
+  state.player.currentRoom = packer.read(snapshotRoomBits);
+  state.player.row = packer.read(snapshotPositionBits);
+  state.player.column = packer.read(snapshotPositionBits);
+  state.player.notes = packer.read(snapshotNotesBits);
+  state.player.lives = packer.read(snapshotLivesBits);
+  state.player.isWinning = false;
+  state.player.hasHighscore = false;
+
+  state.note.currentRoom = packer.read(snapshotRoomBits);
+  state.note.row = packer.read(snapshotPositionBits);
+  state.note.column = packer.read(snapshotPositionBits);
+
+  state.doctor.currentRoom = packer.read(snapshotRoomBits);
+  state.doctor.row = packer.read(snapshotPositionBits);
+  state.doctor.column = packer.read(snapshotPositionBits);
+  state.doctor.isWaiting = packer.read(1);
+  state.doctor.isChasing = packer.read(1);
+  // the Dr. levels up with the 2nd and the 4th note
+  state.doctor.level = 1 + (state.player.notes >= 2) + (state.player.notes >= 4);
+
+  unsigned long sinceMovement = packer.read(snapshotCooldownBits);
+  state.now = packer.read(snapshotTimeBits);
+  state.doctor.lastMovement = state.now - sinceMovement;
+
+  state.random.state = packer.read(32);
+  parSeed = packer.read(snapshotParSeedBits);
+
+  state.isRunning = true;
+  state.isInPause = true;
+  state.events = 0;
+
+  return true;
+}
+
+#endif
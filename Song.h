@@ -0,0 +1,118 @@
+#pragma once
+#ifndef SONG_H
+#define SONG_H
+
+#include "Platform.h"
+#include "PitchTable.h"
+
+/*
+  Songs live in flash, one byte per event:
+  -> the high 4 bits are the index of the pitch in pitches,
+     the low 4 bits the code of its duration in songDurations
+  -> with the pitch 0 (REST), the codes 0 to 12 are rests, and
+     the others control the song: the start of a part played
+     twice, the end of that part, and the end of the song
+
+  They are written as lists of note(), rest() and the control
+  events, turned into bytes while compiling, e.g.
+    constexpr byte song[] PROGMEM = {
+      note(NOTE_G4, 125), rest(62), songRepeatStart,
+      note(NOTE_A4, 250), songRepeatEnd, songEnd
+    };
+*/
+
+// the durations a song can use, in ms
+constexpr unsigned int songDurations[] PROGMEM = {
+  25, 31, 50, 62, 75, 100, 125, 150, 187, 250, 375, 500, 750, 1000, 1500, 2000
+};
+const byte songDurationsSize = sizeof(songDurations) / sizeof(songDurations[0]);
+// rests can use the codes below this one
+const byte songRestCodes = 13;
+
+// control events
+constexpr byte songRepeatStart = 0x0D;
+constexpr byte songRepeatEnd = 0x0E;
+constexpr byte songEnd = 0x0F;
+
+// never defined: reaching one of them while compiling a song is
+// not a constant expression, so the compiler stops and names it
+byte songDurationIsMissing();
+byte songPitchIsMissing();
+byte songRestIsTooLong();
+
+/*
+  Code of the duration, found while compiling.
+*/
+constexpr byte songDurationCode(unsigned int duration, byte code = 0){
+  return code >= songDurationsSize ? songDurationIsMissing()
+       : songDurations[code] == duration ? code
+       : songDurationCode(duration, code + 1);
+}
+
+constexpr byte note(int frequency, unsigned int duration){
+  return pitch(frequency) == 0 && frequency != REST ? songPitchIsMissing()
+       : (pitch(frequency) << 4) | songDurationCode(duration);
+}
+
+constexpr byte rest(unsigned int duration){
+  return songDurationCode(duration) >= songRestCodes ? songRestIsTooLong()
+       : songDurationCode(duration);
+}
+
+/*
+  Reads a song from flash an event at a time, following its
+  repeats, so a song of any length only needs these few bytes.
+*/
+struct SongReader{
+  const byte *song;
+  unsigned int position;
+  // where the repeated part starts
+  unsigned int repeatStart;
+  bool isRepeating;
+
+  SongReader(): song(NULL), position(0), repeatStart(0), isRepeating(false) {}
+
+  void begin(const byte *song);
+  bool next(byte &pitch, unsigned int &duration);
+};
+
+void SongReader::begin(const byte *song){
+  this->song = song;
+  position = 0;
+  repeatStart = 0;
+  isRepeating = false;
+}
+
+/*
+  Read the next note or rest (pitch 0) and its duration,
+  in ms. Returns false at the end of the song.
+*/
+bool SongReader::next(byte &pitch, unsigned int &duration){
+  while (true) {
+    byte event = pgm_read_byte(&song[position]);
+    position += 1;
+
+    pitch = event >> 4;
+    byte code = event & 0x0F;
+
+    if (pitch != 0 || code < songRestCodes) {
+      duration = pgm_read_word(&songDurations[code]);
+      return true;
+    }
+
+    if (code == songRepeatStart) {
+      repeatStart = position;
+    } else if (code == songRepeatEnd) {
+      // the part is played twice, then the song goes on
+      isRepeating = !isRepeating;
+      if (isRepeating) {
+        position = repeatStart;
+      }
+    } else {
+      position -= 1;
+      return false;
+    }
+  }
+}
+
+#endif
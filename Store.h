@@ -0,0 +1,226 @@
+#pragma once
+#ifndef STORE_H
+#define STORE_H
+
+#include <string.h>
+
+#include "EEPROM.h"
+
+#include "ConstantsHighscore.h"
+#include "Crc8.h"
+#include "EepromWriter.h"
+
+// the store takes the EEPROM after the table of highscores,
+// up to the saved games, in the last 544 bytes of the 1 KB
+// on the board (see SavedGame.h)
+const int storeStartAddr = highscoresStartAddr + highscoreSlots * highscoreSize;
+const int storeEndAddr = 1024 - 544;
+// a record: its sequence number (2 bytes, lowest first),
+// the payload, and the CRC-8 of everything before it
+const byte storeSlotSize = 8;
+const byte storeSlots = (storeEndAddr - storeStartAddr) / storeSlotSize;
+const byte storePayloadSize = storeSlotSize - 3;
+// the sequence number of the erased slots, never given to a record
+const unsigned int storeErasedSequence = 0xFFFF;
+
+/*
+  Keeps the settings and the state of the table (the payload,
+  5 bytes laid out by their owners) as a log of records: every
+  save is written to the slot after the newest record, going
+  around the whole store, so each cell is only written once
+  every storeSlots saves (26, between the table and the saved games).
+
+  A record is only trusted if its CRC matches, so a save cut by
+  a power loss leaves the previous record as the newest one; its
+  sequence number is written last, so a half written record is
+  also the oldest until its very end.
+
+  The record is written in the background by the EEPROM writer;
+  a save asked for while the last one is still being written
+  waits for it, and only the latest payload is saved then.
+*/
+struct Store{
+  // the payload of the newest record, changed by the game
+  // before it saves it
+  byte payload[storePayloadSize];
+
+  // slot and sequence number of the newest record, or of the
+  // one being written; storeSlots before the first record
+  byte slot;
+  unsigned int sequence;
+
+  // the record being written, taken when the writing started
+  byte bytes[storeSlotSize];
+  // the payload and the CRC, then the sequence number
+  EepromRequest recordRequest;
+  EepromRequest sequenceRequest;
+  bool isSavePending;
+
+  Store(): slot(storeSlots), sequence(0), isSavePending(false) {
+    memset(payload, 0xFF, sizeof(payload));
+  }
+
+  template <class T> void get(byte offset, T &value);
+  template <class T> void put(byte offset, const T &value);
+
+  bool load();
+  bool readRecord(byte slot);
+  void save();
+  void update();
+  bool isSaved() const;
+  void flush();
+};
+
+Store store;
+
+int storeSlotAddr(byte slot){
+  return storeStartAddr + slot * storeSlotSize;
+}
+
+unsigned int readStoreSequence(byte slot){
+  int address = storeSlotAddr(slot);
+  return EEPROM.read(address) | (EEPROM.read(address + 1) << 8);
+}
+
+/*
+  Read or change a value of the payload, like EEPROM.get
+  and EEPROM.put do, without writing it yet.
+*/
+template <class T>
+void Store::get(byte offset, T &value){
+  memcpy((void *) &value, payload + offset, sizeof(T));
+}
+
+template <class T>
+void Store::put(byte offset, const T &value){
+  memcpy(payload + offset, (const void *) &value, sizeof(T));
+}
+
+/*
+  Find the newest valid record and take its payload. Only the
+  sequence numbers are read to find it, so usually only one
+  record has its CRC checked; the ones that fail it are left out
+  and the next newest is tried. Every slot is tried at most once:
+  the numbers wrap around, so "newer" does not order any set of
+  them, like the bytes of an EEPROM the store was never in.
+
+  Returns false, and leaves the payload as it is, if there is
+  no valid record.
+*/
+bool Store::load(){
+  eepromWriter.flush();
+
+  // a bit for every slot whose CRC did not match
+  byte rejected[(storeSlots + 7) / 8];
+  memset(rejected, 0, sizeof(rejected));
+
+  for (byte tries = 0; tries < storeSlots; tries++) {
+    byte newest = storeSlots;
+    unsigned int newestSequence = 0;
+
+    for (byte i = 0; i < storeSlots; i++) {
+      unsigned int sequence = readStoreSequence(i);
+
+      if (sequence == storeErasedSequence || (rejected[i / 8] & (1 << (i % 8)))) {
+        continue;
+      }
+
+      // the numbers wrap around, the newest is the one ahead of the others
+      if (newest == storeSlots || (int16_t) (sequence - newestSequence) > 0) {
+        newest = i;
+        newestSequence = sequence;
+      }
+    }
+
+    if (newest == storeSlots) {
+      return false;
+    }
+
+    if (readRecord(newest)) {
+      slot = newest;
+      sequence = newestSequence;
+      return true;
+    }
+
+    rejected[newest / 8] |= 1 << (newest % 8);
+  }
+
+  return false;
+}
+
+/*
+  Take the payload of the record in the slot, if its CRC matches.
+*/
+bool Store::readRecord(byte slot){
+  int address = storeSlotAddr(slot);
+
+  for (byte i = 0; i < storeSlotSize; i++) {
+    bytes[i] = EEPROM.read(address + i);
+  }
+
+  if (bytes[storeSlotSize - 1] != crc8(bytes, storeSlotSize - 1)) {
+    return false;
+  }
+
+  memcpy(payload, bytes + 2, storePayloadSize);
+  return true;
+}
+
+/*
+  Write the payload as the newest record, as soon
+  as the record before it is written.
+*/
+void Store::save(){
+  isSavePending = true;
+  update();
+}
+
+/*
+  Start writing the pending save, once the record before it is
+  written: the payload and the CRC first, then the sequence
+  number, which makes it the newest one.
+*/
+void Store::update(){
+  if (!isSavePending || !sequenceRequest.isDone || eepromWriter.freeSpace() < 2) {
+    return;
+  }
+
+  slot = slot + 1 < storeSlots ? slot + 1 : 0;
+
+  sequence += 1;
+  if (sequence == storeErasedSequence) {
+    sequence = 0;
+  }
+
+  bytes[0] = sequence;
+  bytes[1] = sequence >> 8;
+  memcpy(bytes + 2, payload, storePayloadSize);
+  bytes[storeSlotSize - 1] = crc8(bytes, storeSlotSize - 1);
+
+  int address = storeSlotAddr(slot);
+  eepromWriter.write(recordRequest, address + 2, bytes + 2, storeSlotSize - 2);
+  eepromWriter.write(sequenceRequest, address, bytes, 2);
+  isSavePending = false;
+}
+
+/*
+  Returns true once every save asked for is written.
+*/
+bool Store::isSaved() const{
+  return !isSavePending && sequenceRequest.isDone;
+}
+
+/*
+  Wait until every save asked for is written, before
+  anything that resets the board or turns it off.
+*/
+void Store::flush(){
+  while (!isSaved()) {
+    update();
+    eepromWriter.update();
+  }
+
+  eepromWriter.flush();
+}
+
+#endif
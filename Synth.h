@@ -0,0 +1,175 @@
+#pragma once
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include "Platform.h"
+#include "PitchTable.h"
+
+const byte synthVoicesSize = 2;
+// PWM duty of a voice in the high half of its wave; both voices
+// together fill the 8 bits of the PWM
+const byte synthVoiceLevel = 127;
+
+/*
+  A square wave: the high bit of its phase accumulator says
+  which half of the period the sample is in.
+*/
+struct Voice{
+  unsigned int phase;
+  unsigned int step;
+};
+
+/*
+  Two voice synthesizer on the buzzer. Timer2 drives pin 3 (OC2B)
+  with an 8 bit PWM at 31.4 kHz, and its overflow interrupt makes a
+  sample every synthOversampling periods, at 7.8 kHz: it moves the
+  phase of both voices and writes their sum as the PWM duty.
+
+  The interrupt is written in assembly, so its cost does not
+  depend on the compiler's prologue; counted from the AVR's
+  instruction timings, with the 4 cycles of the interrupt's
+  response and the 3 of the vector's jump:
+  -> 27 cycles for the 3 periods out of 4 without a sample
+  -> 78 cycles for the period with a sample
+  so 159 cycles out of the 2040 of 4 PWM periods, 7.8 % of the
+  CPU while the synthesizer runs.
+*/
+Voice voices[synthVoicesSize];
+byte synthCountdown = synthOversampling;
+
+byte synthBuzzerPin;
+// pitches of the voices, played through tone() off the board
+byte voicePitches[synthVoicesSize];
+
+#ifdef __AVR__
+
+/*
+  Count the periods down and, every synthOversampling of them:
+  phase += step for both voices, then the duty is the sum of
+  synthVoiceLevel for each voice in the high half of its wave.
+  Only r24, r25, r18, r19 and the status register are used.
+*/
+ISR(TIMER2_OVF_vect, ISR_NAKED){
+  asm volatile(
+    "push r24\n"
+    "in r24, __SREG__\n"
+    "push r24\n"
+
+    "lds r24, %[countdown]\n"
+    "dec r24\n"
+    "sts %[countdown], r24\n"
+    "breq 1f\n"
+
+    "pop r24\n"
+    "out __SREG__, r24\n"
+    "pop r24\n"
+    "reti\n"
+
+    "1:\n"
+    "ldi r24, %[oversampling]\n"
+    "sts %[countdown], r24\n"
+    "push r25\n"
+    "push r18\n"
+    "push r19\n"
+    "clr r25\n"
+
+    "lds r18, %[phase0]\n"
+    "lds r19, %[phase0] + 1\n"
+    "lds r24, %[step0]\n"
+    "add r18, r24\n"
+    "lds r24, %[step0] + 1\n"
+    "adc r19, r24\n"
+    "sts %[phase0], r18\n"
+    "sts %[phase0] + 1, r19\n"
+    "sbrc r19, 7\n"
+    "subi r25, lo8(-(%[level]))\n"
+
+    "lds r18, %[phase1]\n"
+    "lds r19, %[phase1] + 1\n"
+    "lds r24, %[step1]\n"
+    "add r18, r24\n"
+    "lds r24, %[step1] + 1\n"
+    "adc r19, r24\n"
+    "sts %[phase1], r18\n"
+    "sts %[phase1] + 1, r19\n"
+    "sbrc r19, 7\n"
+    "subi r25, lo8(-(%[level]))\n"
+
+    "sts %[duty], r25\n"
+
+    "pop r19\n"
+    "pop r18\n"
+    "pop r25\n"
+    "pop r24\n"
+    "out __SREG__, r24\n"
+    "pop r24\n"
+    "reti\n"
+    :
+    : [countdown] "i" (&synthCountdown),
+      [oversampling] "M" (synthOversampling),
+      [phase0] "i" (&voices[0].phase),
+      [step0] "i" (&voices[0].step),
+      [phase1] "i" (&voices[1].phase),
+      [step1] "i" (&voices[1].step),
+      [level] "M" (synthVoiceLevel),
+      [duty] "n" (_SFR_MEM_ADDR(OCR2B))
+  );
+}
+
+static_assert(synthVoicesSize == 2, "the interrupt mixes two voices");
+
+#endif
+
+/*
+  Take Timer2 over for the buzzer, which has
+  to be on pin 3 (OC2B) on the board.
+*/
+void startSynth(byte buzzerPin){
+  synthBuzzerPin = buzzerPin;
+  pinMode(buzzerPin, OUTPUT);
+  digitalWrite(buzzerPin, LOW);
+
+#ifdef __AVR__
+  // phase correct PWM up to 0xFF, without a prescaler,
+  // clearing OC2B on the way up
+  OCR2B = 0;
+  TCCR2A = (1 << COM2B1) | (1 << WGM20);
+  TCCR2B = (1 << CS20);
+  TIMSK2 = (1 << TOIE2);
+#endif
+}
+
+/*
+  Play the pitch with the given index in pitches on the voice;
+  0 keeps it quiet. Called with the interrupts turned off, or
+  from another interrupt, so a step is never half written.
+*/
+void setVoice(byte voice, byte pitch){
+#ifdef __AVR__
+  voices[voice].step = pgm_read_word(&pitches[pitch].step);
+
+  // a quiet voice stays in the low half of its wave
+  if (pitch == 0) {
+    voices[voice].phase = 0;
+  }
+#else
+  voicePitches[voice] = pitch;
+
+  // tone() plays a single voice, the last one that is not quiet
+  byte playing = 0;
+  for (byte i = 0; i < synthVoicesSize; i++) {
+    if (voicePitches[i] != 0) {
+      playing = voicePitches[i];
+    }
+  }
+
+  int frequency = pgm_read_word(&pitches[playing].frequency);
+  if (frequency == REST) {
+    noTone(synthBuzzerPin);
+  } else {
+    tone(synthBuzzerPin, frequency);
+  }
+#endif
+}
+
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+#ifndef TUNED_CONSTANTS_H
+#define TUNED_CONSTANTS_H
+
+#include "Platform.h"
+
+/*
+  Dr. Nocturne's chase parameters.
+
+  Generated by tools/AutoTune.cpp, do not edit by hand.
+  These are the original hand-picked values, the tuner
+  overwrites them with the ones that hit its targets.
+*/
+
+// interval time between movements on level 2, in ms
+const int movementCooldown = 1000;
+// interval time between movements on level 3, in ms
+const int movementCooldownLastLevel = 850;
+// distance at which Dr. Nocturne starts chasing on level 2
+const byte chaseDistance = 5;
+// distance at which Dr. Nocturne starts chasing on level 3
+const byte chaseDistanceLastLevel = 3;
+
+#endif
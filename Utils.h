@@ -4,6 +4,7 @@
 
 #include <math.h>
 #include <LiquidCrystal.h>
+#include "Log.h"
 
 /*
   Given an array of chars, concatenate (from index 0 to nth) 
@@ -49,7 +50,7 @@ bool saveCharAsByteMatrix(char* numberChar[], int numberSize, byte &targetVariab
 
   // transform the char number into a int
   numberInt = numberString.toInt();
-  Serial.println(numberInt);
+  LOG_DEBUG(logMatrixBrightnessTyped, numberInt);
 
   // exit if its not from the interval [0, 15]
   if (numberInt < 0 || numberInt > 15) {
@@ -0,0 +1,446 @@
+/*
+  Sinister Escape - difficulty auto-tuner
+
+  Searches Dr. Nocturne's chase parameters (the movement
+  cooldown and the distance at which he starts chasing, on
+  levels 2 and 3) so the scripted bot wins every level as
+  often as the targets say, then writes them as TunedConstants.h.
+
+  A level is won when it is cleared without being caught on it.
+  Level 2 is searched first and level 3 afterwards, with a coarse
+  grid and then a finer one around the best point; the rounds
+  repeat because the lives lost on one level change the other.
+
+  Every point evaluated is appended to a cache file, keyed by
+  the point, the simulation settings and a signature of the
+  rooms, so running the tuner again only plays the new points.
+  Delete the cache after changing the game rules.
+
+  Build & run, from the repository root:
+    g++ -O2 -std=c++17 -pthread tools/AutoTune.cpp -o autotune
+    ./autotune --target2 0.85 --target3 0.7 --output TunedConstants.h
+
+  Options:
+    --target2 R         win rate wanted on level 2, from 0 to 1 (0.85)
+    --target3 R         win rate wanted on level 3, from 0 to 1 (0.75)
+    --games N           games played for every point (4000)
+    --rounds N          times both levels are searched (2)
+    --seed S            seed of the games (1)
+    --threads T         worker threads, 0 for every core (0)
+    --move-interval MS  minimum time between bot movements (250)
+    --mistakes P        chance in percents of a random bot movement (10)
+    --cache FILE        file keeping the evaluated points (autotune.cache)
+    --output FILE       generated header (TunedConstants.h)
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Simulation.h"
+#include "WorkStealingPool.h"
+
+// bump when the meaning of the cached numbers changes
+const unsigned int cacheFormatVersion = 1;
+
+// search space of the cooldowns, in ms, and of the chase distances
+const int coarseCooldownFirst = 400;
+const int coarseCooldownLast = 1600;
+const int coarseCooldownStep = 100;
+const int fineCooldownStep = 25;
+const int fineCooldownSteps = 4;
+const int minimumCooldown = 200;
+const byte minimumChaseDistance = 1;
+const byte maximumChaseDistance = 7;
+
+struct Options{
+  double targets[simulationLevels + 1];
+  unsigned long games;
+  unsigned int rounds;
+  uint64_t seed;
+  unsigned int threads;
+  SimulationConfig config;
+  std::string cachePath;
+  std::string outputPath;
+
+  Options(): games(4000), rounds(2), seed(1), threads(0), cachePath("autotune.cache"), outputPath("TunedConstants.h"){
+    targets[0] = targets[1] = 1;
+    targets[2] = 0.85;
+    targets[3] = 0.75;
+  }
+};
+
+/*
+  What was measured for one point of the search.
+*/
+struct Evaluation{
+  unsigned long reached[simulationLevels + 1];
+  unsigned long won[simulationLevels + 1];
+  unsigned long escaped;
+
+  double winRate(byte level) const{
+    return reached[level] ? (double) won[level] / reached[level] : 0;
+  }
+};
+
+typedef std::tuple<int, int, int, int> TuningKey;
+
+TuningKey keyOf(const DoctorTuning &tuning){
+  return TuningKey(tuning.movementCooldown, tuning.movementCooldownLastLevel,
+                   tuning.chaseDistance, tuning.chaseDistanceLastLevel);
+}
+
+/*
+  Cache of the evaluated points. A line is only used when it was
+  measured with the same settings, so the file can be shared
+  between runs with different options.
+*/
+struct EvaluationCache{
+  std::string path;
+  std::string settings;
+  std::map<TuningKey, Evaluation> evaluations;
+  unsigned long hits;
+
+  EvaluationCache(): hits(0) {}
+
+  void load(const std::string &path, const std::string &settings);
+  bool find(const DoctorTuning &tuning, Evaluation &evaluation);
+  void store(const DoctorTuning &tuning, const Evaluation &evaluation);
+};
+
+void EvaluationCache::load(const std::string &path, const std::string &settings){
+  this->path = path;
+  this->settings = settings;
+
+  FILE *file = fopen(path.c_str(), "r");
+  if (file == NULL) {
+    return;
+  }
+
+  char line[512];
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char lineSettings[256];
+    int cooldown, cooldownLastLevel, distance, distanceLastLevel;
+    Evaluation evaluation = {};
+
+    int fields = sscanf(line, "%255s %d %d %d %d %lu %lu %lu %lu %lu", lineSettings,
+                        &cooldown, &cooldownLastLevel, &distance, &distanceLastLevel,
+                        &evaluation.reached[2], &evaluation.won[2],
+                        &evaluation.reached[3], &evaluation.won[3], &evaluation.escaped);
+
+    if (fields == 10 && settings == lineSettings) {
+      evaluations[TuningKey(cooldown, cooldownLastLevel, distance, distanceLastLevel)] = evaluation;
+    }
+  }
+
+  fclose(file);
+}
+
+bool EvaluationCache::find(const DoctorTuning &tuning, Evaluation &evaluation){
+  std::map<TuningKey, Evaluation>::const_iterator found = evaluations.find(keyOf(tuning));
+  if (found == evaluations.end()) {
+    return false;
+  }
+
+  evaluation = found->second;
+  hits += 1;
+  return true;
+}
+
+void EvaluationCache::store(const DoctorTuning &tuning, const Evaluation &evaluation){
+  evaluations[keyOf(tuning)] = evaluation;
+
+  FILE *file = fopen(path.c_str(), "a");
+  if (file == NULL) {
+    return;
+  }
+
+  fprintf(file, "%s %d %d %u %u %lu %lu %lu %lu %lu\n", settings.c_str(),
+          tuning.movementCooldown, tuning.movementCooldownLastLevel,
+          tuning.chaseDistance, tuning.chaseDistanceLastLevel,
+          evaluation.reached[2], evaluation.won[2], evaluation.reached[3], evaluation.won[3],
+          evaluation.escaped);
+  fclose(file);
+}
+
+/*
+  Signature of everything, besides the point itself, that changes
+  the measured numbers: the simulation settings and the house.
+*/
+std::string settingsSignature(const Options &options){
+  uint32_t hash = 2166136261u;
+  for (byte room = 0; room < roomsSize; room++) {
+    for (byte row = 0; row < matrixSize; row++) {
+      for (byte column = 0; column < matrixSize; column++) {
+        hash = (hash ^ rooms[room][row][column]) * 16777619u;
+      }
+    }
+
+    for (byte direction = 0; direction < directions; direction++) {
+      hash = (hash ^ roomsCommunication[room][direction]) * 16777619u;
+    }
+  }
+
+  char signature[256];
+  snprintf(signature, sizeof(signature), "v%u/%08x/g%lu/s%llu/m%u/e%u/dt%u/t%lu",
+           cacheFormatVersion, hash, options.games, (unsigned long long) options.seed,
+           options.config.moveInterval, options.config.mistakeChance, options.config.dt,
+           options.config.timeLimit);
+  return signature;
+}
+
+/*
+  Evaluate every point, playing the games of the points missing
+  from the cache all together on the pool.
+*/
+std::vector<Evaluation> evaluatePoints(const std::vector<DoctorTuning> &points, const Options &options,
+                                       WorkStealingPool &pool, EvaluationCache &cache){
+  std::vector<Evaluation> evaluations(points.size());
+  std::vector<size_t> missing;
+
+  for (size_t point = 0; point < points.size(); point++) {
+    if (!cache.find(points[point], evaluations[point])) {
+      missing.push_back(point);
+    }
+  }
+
+  if (missing.empty()) {
+    return evaluations;
+  }
+
+  // the same seeds are used for every point, so the points
+  // are compared on exactly the same games
+  std::vector<GameResult> results(missing.size() * options.games);
+  pool.parallelFor(results.size(), 64, [&](size_t index) {
+    size_t point = missing[index / options.games];
+    size_t game = index % options.games;
+
+    results[index] = simulateGame(mixSeed(options.seed, game), options.config, points[point]);
+  });
+
+  for (size_t slot = 0; slot < missing.size(); slot++) {
+    LevelStats stats;
+    unsigned long escaped = 0;
+
+    for (size_t game = 0; game < options.games; game++) {
+      const GameResult &result = results[slot * options.games + game];
+      stats.add(result);
+      escaped += result.won;
+    }
+
+    Evaluation &evaluation = evaluations[missing[slot]];
+    evaluation = Evaluation();
+    for (byte level = 0; level <= simulationLevels; level++) {
+      evaluation.reached[level] = stats.reached[level];
+      evaluation.won[level] = stats.won[level];
+    }
+    evaluation.escaped = escaped;
+
+    cache.store(points[missing[slot]], evaluation);
+  }
+
+  return evaluations;
+}
+
+int &cooldownOf(DoctorTuning &tuning, byte level){
+  return level == 2 ? tuning.movementCooldown : tuning.movementCooldownLastLevel;
+}
+
+byte &distanceOf(DoctorTuning &tuning, byte level){
+  return level == 2 ? tuning.chaseDistance : tuning.chaseDistanceLastLevel;
+}
+
+/*
+  Pick the point whose win rate on the level is the closest to
+  the target; on a tie, keep the one closest to the current point.
+*/
+size_t closestToTarget(const std::vector<DoctorTuning> &points, const std::vector<Evaluation> &evaluations,
+                       byte level, double target, const DoctorTuning &current){
+  size_t best = 0;
+  double bestError = 2, bestChange = 0;
+
+  for (size_t point = 0; point < points.size(); point++) {
+    DoctorTuning candidate = points[point];
+    DoctorTuning reference = current;
+
+    double error = fabs(evaluations[point].winRate(level) - target);
+    double change = fabs((double) cooldownOf(candidate, level) - cooldownOf(reference, level)) / coarseCooldownStep
+                    + abs((int) distanceOf(candidate, level) - distanceOf(reference, level));
+
+    if (error < bestError - 1e-9 || (fabs(error - bestError) <= 1e-9 && change < bestChange)) {
+      best = point;
+      bestError = error;
+      bestChange = change;
+    }
+  }
+
+  return best;
+}
+
+/*
+  Search the cooldown and the chase distance of one level,
+  leaving the other level's parameters as they are.
+*/
+DoctorTuning searchLevel(DoctorTuning current, byte level, const Options &options,
+                         WorkStealingPool &pool, EvaluationCache &cache){
+  // coarse grid over the whole search space
+  std::vector<DoctorTuning> points;
+  for (int cooldown = coarseCooldownFirst; cooldown <= coarseCooldownLast; cooldown += coarseCooldownStep) {
+    for (byte distance = minimumChaseDistance; distance <= maximumChaseDistance; distance++) {
+      DoctorTuning point = current;
+      cooldownOf(point, level) = cooldown;
+      distanceOf(point, level) = distance;
+      points.push_back(point);
+    }
+  }
+
+  std::vector<Evaluation> evaluations = evaluatePoints(points, options, pool, cache);
+  DoctorTuning best = points[closestToTarget(points, evaluations, level, options.targets[level], current)];
+
+  // finer cooldowns around the best point of the grid
+  points.clear();
+  for (int offset = -fineCooldownSteps; offset <= fineCooldownSteps; offset++) {
+    DoctorTuning point = best;
+    cooldownOf(point, level) += offset * fineCooldownStep;
+
+    if (cooldownOf(point, level) >= minimumCooldown) {
+      points.push_back(point);
+    }
+  }
+
+  evaluations = evaluatePoints(points, options, pool, cache);
+  size_t chosen = closestToTarget(points, evaluations, level, options.targets[level], best);
+
+  printf("  level %u: cooldown %4d ms, chase distance %u -> win rate %.2f %% (target %.2f %%)\n",
+         level, cooldownOf(points[chosen], level), distanceOf(points[chosen], level),
+         100 * evaluations[chosen].winRate(level), 100 * options.targets[level]);
+
+  return points[chosen];
+}
+
+bool writeHeader(const std::string &path, const DoctorTuning &tuning, const Evaluation &evaluation, const Options &options){
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == NULL) {
+    return false;
+  }
+
+  fprintf(file,
+          "#pragma once\n"
+          "#ifndef TUNED_CONSTANTS_H\n"
+          "#define TUNED_CONSTANTS_H\n"
+          "\n"
+          "#include \"Platform.h\"\n"
+          "\n"
+          "/*\n"
+          "  Dr. Nocturne's chase parameters.\n"
+          "\n"
+          "  Generated by tools/AutoTune.cpp, do not edit by hand.\n"
+          "  Targets: level 2 won %.0f %%, level 3 won %.0f %% of the times.\n"
+          "  Measured: level 2 won %.1f %%, level 3 won %.1f %%, escaped %.1f %%,\n"
+          "  over %lu bot games (%u %% mistakes, moving every %u ms).\n"
+          "*/\n"
+          "\n"
+          "// interval time between movements on level 2, in ms\n"
+          "const int movementCooldown = %d;\n"
+          "// interval time between movements on level 3, in ms\n"
+          "const int movementCooldownLastLevel = %d;\n"
+          "// distance at which Dr. Nocturne starts chasing on level 2\n"
+          "const byte chaseDistance = %u;\n"
+          "// distance at which Dr. Nocturne starts chasing on level 3\n"
+          "const byte chaseDistanceLastLevel = %u;\n"
+          "\n"
+          "#endif\n",
+          100 * options.targets[2], 100 * options.targets[3],
+          100 * evaluation.winRate(2), 100 * evaluation.winRate(3), 100.0 * evaluation.escaped / options.games,
+          options.games, options.config.mistakeChance, options.config.moveInterval,
+          tuning.movementCooldown, tuning.movementCooldownLastLevel,
+          tuning.chaseDistance, tuning.chaseDistanceLastLevel);
+
+  fclose(file);
+  return true;
+}
+
+bool parseOptions(int argc, char **argv, Options &options){
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      fprintf(stderr, "missing value for %s\n", argv[i]);
+      return false;
+    }
+
+    const char *name = argv[i];
+    const char *value = argv[++i];
+
+    if (strcmp(name, "--target2") == 0) {
+      options.targets[2] = atof(value);
+    } else if (strcmp(name, "--target3") == 0) {
+      options.targets[3] = atof(value);
+    } else if (strcmp(name, "--games") == 0) {
+      options.games = strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--rounds") == 0) {
+      options.rounds = (unsigned int) strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--seed") == 0) {
+      options.seed = strtoull(value, NULL, 10);
+    } else if (strcmp(name, "--threads") == 0) {
+      options.threads = (unsigned int) strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--move-interval") == 0) {
+      options.config.moveInterval = (unsigned int) strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--mistakes") == 0) {
+      options.config.mistakeChance = (byte) strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--cache") == 0) {
+      options.cachePath = value;
+    } else if (strcmp(name, "--output") == 0) {
+      options.outputPath = value;
+    } else {
+      fprintf(stderr, "unknown option %s %s\n", name, value);
+      return false;
+    }
+  }
+
+  if (options.games == 0 || options.config.mistakeChance > 100) {
+    fprintf(stderr, "invalid options\n");
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv){
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    return 1;
+  }
+
+  WorkStealingPool pool(options.threads);
+  EvaluationCache cache;
+  cache.load(options.cachePath, settingsSignature(options));
+
+  printf("%lu games per point, %u threads, %zu cached points\n",
+         options.games, pool.threads, cache.evaluations.size());
+
+  DoctorTuning tuning = defaultDoctorTuning;
+  for (unsigned int round = 1; round <= options.rounds; round++) {
+    printf("round %u\n", round);
+    tuning = searchLevel(tuning, 2, options, pool, cache);
+    tuning = searchLevel(tuning, 3, options, pool, cache);
+  }
+
+  Evaluation evaluation = evaluatePoints(std::vector<DoctorTuning>(1, tuning), options, pool, cache)[0];
+
+  printf("\ncache hits %lu, %zu cached points\n", cache.hits, cache.evaluations.size());
+  printf("movementCooldown %d, movementCooldownLastLevel %d, chaseDistance %u, chaseDistanceLastLevel %u\n",
+         tuning.movementCooldown, tuning.movementCooldownLastLevel, tuning.chaseDistance, tuning.chaseDistanceLastLevel);
+
+  if (!writeHeader(options.outputPath, tuning, evaluation, options)) {
+    fprintf(stderr, "cannot write %s\n", options.outputPath.c_str());
+    return 1;
+  }
+
+  printf("written to %s\n", options.outputPath.c_str());
+  return 0;
+}
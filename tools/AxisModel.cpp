@@ -0,0 +1,239 @@
+/*
+  Sinister Escape - joystick sampler model
+
+  Runs the board's side of AxisSampler.h (its ADC interrupt) on a
+  model of the ATmega328P's ADC in free running mode: a conversion
+  takes 13 ADC clocks, 104 µs at 16 MHz / 128, and the next one
+  starts as soon as it ends, on the channel ADMUX selects at that
+  moment, before the interrupt gets to change it.
+
+  It reports:
+  -> if each axis only gets its own channel's samples
+  -> the noise left on an axis, against the noise of one sample
+  -> how long a push of the stick takes to show in the axis
+     value read by the joystick task
+
+  Build & run, from the repository root:
+    g++ -O2 -std=c++17 tools/AxisModel.cpp -o axismodel
+    ./axismodel
+
+  Options:
+    --noise LSB    standard deviation of the noise of a sample (3)
+    --steps N      pushes of the stick timed for the latency (1000)
+    --seed S       seed of the noise and of the push times (1)
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <random>
+
+typedef uint8_t byte;
+
+// the registers of the ADC, and what the sampler needs around them
+#define __AVR__
+#define ISR(vector) void vector()
+
+uint16_t ADC;
+uint8_t ADMUX, ADCSRA, ADCSRB, DIDR0;
+enum {ADPS0, ADPS1, ADPS2, ADIE, ADIF, ADATE, ADSC, ADEN};
+const uint8_t REFS0 = 6;
+const uint8_t A0 = 14;
+
+void noInterrupts(){}
+void interrupts(){}
+
+#include "../AxisSampler.h"
+
+// time of one conversion, in µs
+const double conversionTime = 13 * 128 / 16.0;
+// pins of the axes, like in the sketch
+const byte pinX = A0;
+const byte pinY = A0 + 1;
+
+/*
+  The ADC and the voltages on its two channels.
+*/
+struct AdcModel{
+  std::mt19937 random;
+  std::normal_distribution<double> noise;
+  double levels[2];
+  // channel latched for the conversion going on
+  byte channel;
+  // time the conversion going on ends at, in µs
+  double time;
+
+  AdcModel(uint32_t seed, double noiseLsb): random(seed), noise(0.0, noiseLsb), channel(0), time(0) {
+    levels[0] = 512;
+    levels[1] = 512;
+  }
+
+  void start();
+  void convert();
+};
+
+void AdcModel::start(){
+  startAxisSampler(pinX, pinY);
+  channel = ADMUX & 0x0F;
+  time = conversionTime;
+}
+
+/*
+  End the conversion going on: the next one starts right away on
+  the channel selected now, then the interrupt takes the result.
+*/
+void AdcModel::convert(){
+  double sample = levels[channel] + noise(random);
+  sample = floor(sample + 0.5);
+  ADC = (uint16_t) (sample < 0 ? 0 : sample > 1023 ? 1023 : sample);
+
+  channel = ADMUX & 0x0F;
+  time += conversionTime;
+
+  ADC_vect();
+}
+
+/*
+  Both channels held still at different levels: every
+  axis value has to be its own channel's level.
+*/
+bool checkChannels(){
+  AdcModel adc(1, 0.0);
+  adc.levels[0] = 100;
+  adc.levels[1] = 900;
+  adc.start();
+
+  for (int i = 0; i < 4 * 2 * axisSamplesAveraged; i++) {
+    adc.convert();
+  }
+
+  int x, y;
+  readAxes(x, y);
+  printf("channels: X %d (100), Y %d (900)\n", x, y);
+  return x == 100 && y == 900;
+}
+
+/*
+  Standard deviation of the axis values with the stick
+  in the middle, against the one of a single sample.
+*/
+void measureNoise(uint32_t seed, double noiseLsb){
+  AdcModel adc(seed, noiseLsb);
+  adc.start();
+
+  double sum = 0, squares = 0;
+  unsigned long values = 0;
+
+  for (int i = 0; i < 2 * axisSamplesAveraged * 20000; i++) {
+    adc.convert();
+
+    // a new value of X every 2 * axisSamplesAveraged conversions
+    if (i % (2 * axisSamplesAveraged) == 2 * axisSamplesAveraged - 1 && i > 4 * axisSamplesAveraged) {
+      int x, y;
+      readAxes(x, y);
+      sum += x;
+      squares += (double) x * x;
+      values += 1;
+    }
+  }
+
+  double mean = sum / values;
+  double deviation = sqrt(squares / values - mean * mean);
+  printf("noise: a sample %.2f LSB, an axis value %.2f LSB (%.1fx less), mean %.1f (512)\n",
+         noiseLsb, deviation, deviation > 0 ? noiseLsb / deviation : 0.0, mean);
+}
+
+/*
+  Push X from the middle to the end at a random time, and
+  time how long the value read takes to get half way, which is
+  about where the deadzone ends, and all the way.
+*/
+void measureLatency(uint32_t seed, double noiseLsb, unsigned long steps){
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<double> phase(0.0, 2 * axisSamplesAveraged * conversionTime);
+
+  double halfTotal = 0, fullTotal = 0;
+  double halfMost = 0, fullMost = 0;
+  double halfLeast = 1e9, fullLeast = 1e9;
+
+  for (unsigned long step = 0; step < steps; step++) {
+    AdcModel adc(seed + step, noiseLsb);
+    adc.start();
+
+    // let the averages settle, then push at a random moment
+    double pushTime = 10 * 2 * axisSamplesAveraged * conversionTime + phase(random);
+    double halfTime = -1, fullTime = -1;
+
+    while (fullTime < 0) {
+      // the voltage changes for the conversions that start after the push
+      if (adc.time - conversionTime >= pushTime) {
+        adc.levels[0] = 1000;
+      }
+      adc.convert();
+
+      int x, y;
+      readAxes(x, y);
+
+      if (halfTime < 0 && x >= 756) {
+        halfTime = adc.time - conversionTime - pushTime;
+      }
+      if (x >= 1000 - 3 * noiseLsb) {
+        fullTime = adc.time - conversionTime - pushTime;
+      }
+    }
+
+    halfTotal += halfTime;
+    fullTotal += fullTime;
+    halfLeast = std::min(halfLeast, halfTime);
+    fullLeast = std::min(fullLeast, fullTime);
+    halfMost = std::max(halfMost, halfTime);
+    fullMost = std::max(fullMost, fullTime);
+  }
+
+  printf("latency, half way: min %.2f ms, avg %.2f ms, max %.2f ms\n",
+         halfLeast / 1000, halfTotal / steps / 1000, halfMost / 1000);
+  printf("latency, all the way: min %.2f ms, avg %.2f ms, max %.2f ms\n",
+         fullLeast / 1000, fullTotal / steps / 1000, fullMost / 1000);
+  printf("(the joystick task reads the axes every 1 ms, which can add up to 1 ms)\n");
+}
+
+int main(int argc, char **argv){
+  double noiseLsb = 3;
+  unsigned long steps = 1000;
+  uint32_t seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      fprintf(stderr, "missing value for %s\n", argv[i]);
+      return 1;
+    }
+
+    const char *name = argv[i];
+    const char *value = argv[++i];
+
+    if (strcmp(name, "--noise") == 0) {
+      noiseLsb = atof(value);
+    } else if (strcmp(name, "--steps") == 0 && atol(value) > 0) {
+      steps = strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--seed") == 0) {
+      seed = (uint32_t) strtoul(value, NULL, 10);
+    } else {
+      fprintf(stderr, "unknown option %s %s\n", name, value);
+      return 1;
+    }
+  }
+
+  bool isSeparated = checkChannels();
+  measureNoise(seed, noiseLsb);
+  measureLatency(seed, noiseLsb, steps);
+
+  if (!isSeparated) {
+    fprintf(stderr, "an axis got the samples of the other channel\n");
+    return 1;
+  }
+
+  return 0;
+}
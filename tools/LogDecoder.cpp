@@ -0,0 +1,195 @@
+/*
+  Sinister Escape - log decoder
+
+  Turns the log records the board sends over the serial port
+  (see Log.h) back into text: every record is the marker with
+  its level, the index of its message in LogMessages.h, and its
+  arguments, which the message's format says how to read.
+
+  Bytes that do not start a whole record, like the ones sent
+  before the capture started, are skipped until the next record,
+  and counted.
+
+  Build & run, from the repository root:
+    g++ -O2 -std=c++17 tools/LogDecoder.cpp -o logdecoder
+    ./logdecoder --input capture.bin
+
+  Options:
+    --input FILE  captured serial output, the standard input if not given
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+typedef uint8_t byte;
+
+#include "../LogMessages.h"
+
+// the same as in Log.h, which needs the board's serial port
+const byte logRecordMarker = 0xF0;
+const byte logStringMaximumSize = 15;
+
+#define LOG_MESSAGE_FORMAT(id, format) format,
+
+const char *logFormats[] = {
+  LOG_MESSAGES(LOG_MESSAGE_FORMAT)
+};
+
+const char *logLevels[] = {"debug", "info", "warning", "error"};
+
+/*
+  Reads the arguments of one record, failing
+  at the end of the capture or on a bad byte.
+*/
+struct RecordReader{
+  const std::vector<byte> &bytes;
+  size_t position;
+
+  RecordReader(const std::vector<byte> &bytes, size_t position): bytes(bytes), position(position) {}
+
+  bool number(uint32_t &value);
+  bool text(std::string &value);
+};
+
+bool RecordReader::number(uint32_t &value){
+  value = 0;
+
+  for (byte shift = 0; shift < 35; shift += 7) {
+    if (position >= bytes.size()) {
+      return false;
+    }
+
+    byte part = bytes[position++];
+    value |= (uint32_t) (part & 0x7F) << shift;
+
+    if ((part & 0x80) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool RecordReader::text(std::string &value){
+  value.clear();
+
+  while (position < bytes.size()) {
+    byte character = bytes[position++];
+
+    if (character == '\0') {
+      return true;
+    }
+    // names are plain text, anything else means it is not a record
+    if (character < ' ' || character > '~' || value.size() >= logStringMaximumSize) {
+      return false;
+    }
+    value += (char) character;
+  }
+
+  return false;
+}
+
+/*
+  Decode the record at the position, as its text. Returns
+  the position after it, or 0 if no record starts there.
+*/
+size_t decodeRecord(const std::vector<byte> &bytes, size_t position, std::string &line){
+  if (position + 1 >= bytes.size() || (bytes[position] & 0xFC) != logRecordMarker || bytes[position + 1] >= logMessagesSize) {
+    return 0;
+  }
+
+  byte level = bytes[position] & 0x03;
+  const char *format = logFormats[bytes[position + 1]];
+  RecordReader reader(bytes, position + 2);
+
+  line = "[";
+  line += logLevels[level];
+  line += "] ";
+
+  char buffer[16];
+
+  for (const char *c = format; *c != '\0'; c++) {
+    if (*c != '%') {
+      line += *c;
+      continue;
+    }
+
+    uint32_t number;
+    std::string text;
+
+    if (strncmp(c, "%lu", 3) == 0 && reader.number(number)) {
+      snprintf(buffer, sizeof(buffer), "%lu", (unsigned long) number);
+      line += buffer;
+      c += 2;
+    } else if (strncmp(c, "%ld", 3) == 0 && reader.number(number)) {
+      snprintf(buffer, sizeof(buffer), "%ld", (long) (int32_t) number);
+      line += buffer;
+      c += 2;
+    } else if (strncmp(c, "%s", 2) == 0 && reader.text(text)) {
+      line += text;
+      c += 1;
+    } else {
+      return 0;
+    }
+  }
+
+  return reader.position;
+}
+
+int main(int argc, char **argv){
+  std::string inputPath;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+      inputPath = argv[++i];
+    } else {
+      fprintf(stderr, "usage: logdecoder [--input FILE]\n");
+      return 1;
+    }
+  }
+
+  FILE *file = inputPath.empty() ? stdin : fopen(inputPath.c_str(), "rb");
+  if (file == NULL) {
+    fprintf(stderr, "cannot read %s\n", inputPath.c_str());
+    return 1;
+  }
+
+  std::vector<byte> bytes;
+  byte buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    bytes.insert(bytes.end(), buffer, buffer + size);
+  }
+
+  if (file != stdin) {
+    fclose(file);
+  }
+
+  unsigned long records = 0, skipped = 0;
+  size_t position = 0;
+  std::string line;
+
+  while (position < bytes.size()) {
+    size_t next = decodeRecord(bytes, position, line);
+
+    if (next == 0) {
+      skipped += 1;
+      position += 1;
+      continue;
+    }
+
+    printf("%s\n", line.c_str());
+    records += 1;
+    position = next;
+  }
+
+  if (skipped > 0) {
+    fprintf(stderr, "%lu records, %lu bytes skipped\n", records, skipped);
+  }
+
+  return 0;
+}
@@ -0,0 +1,251 @@
+/*
+  Sinister Escape - Monte Carlo balancing harness
+
+  Plays thousands of games on the host with the scripted bot,
+  using the same rules as the board (GameState, DrNocturne,
+  Note, rooms[]), and reports how winnable the game is:
+  the win rate, the time needed to escape and where the
+  player gets caught on every level.
+
+  Every game is seeded from the sweep seed and its index,
+  so the report is identical for a given seed, no matter
+  how many threads played the games.
+
+  Build & run, from the repository root:
+    g++ -O2 -std=c++17 -pthread tools/MonteCarlo.cpp -o montecarlo
+    ./montecarlo --games 100000 --seed 1
+
+  Options:
+    --games N           number of games to play (100000)
+    --seed S            seed of the sweep (1)
+    --threads T         worker threads, 0 for every core (0)
+    --dt MS             game time advanced by every step (10)
+    --move-interval MS  minimum time between bot movements (250)
+    --mistakes P        chance in percents of a random bot movement (10)
+    --time-limit S      games longer than this are stopped (900)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "Simulation.h"
+#include "WorkStealingPool.h"
+
+// width of a bucket in the time to escape histogram, in seconds
+const unsigned int histogramBucketSeconds = 30;
+// width of the longest histogram bar
+const unsigned int histogramBarWidth = 50;
+
+struct Options{
+  unsigned long games;
+  uint64_t seed;
+  unsigned int threads;
+  SimulationConfig config;
+
+  Options(): games(100000), seed(1), threads(0) {}
+};
+
+bool parseOptions(int argc, char **argv, Options &options){
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      fprintf(stderr, "missing value for %s\n", argv[i]);
+      return false;
+    }
+
+    const char *name = argv[i];
+    unsigned long long value = strtoull(argv[++i], NULL, 10);
+
+    if (strcmp(name, "--games") == 0) {
+      options.games = value;
+    } else if (strcmp(name, "--seed") == 0) {
+      options.seed = value;
+    } else if (strcmp(name, "--threads") == 0) {
+      options.threads = (unsigned int) value;
+    } else if (strcmp(name, "--dt") == 0 && value > 0) {
+      options.config.dt = (unsigned int) value;
+    } else if (strcmp(name, "--move-interval") == 0) {
+      options.config.moveInterval = (unsigned int) value;
+    } else if (strcmp(name, "--mistakes") == 0 && value <= 100) {
+      options.config.mistakeChance = (byte) value;
+    } else if (strcmp(name, "--time-limit") == 0) {
+      options.config.timeLimit = value * 1000UL;
+    } else {
+      fprintf(stderr, "unknown option %s %s\n", name, argv[i]);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+  Value at the given percentile of sorted values.
+*/
+unsigned long percentile(const std::vector<unsigned long> &values, unsigned int percent){
+  if (values.empty()) {
+    return 0;
+  }
+
+  return values[(values.size() - 1) * percent / 100];
+}
+
+void printLevels(const std::vector<GameResult> &results){
+  LevelStats stats;
+  for (const GameResult &result : results) {
+    stats.add(result);
+  }
+
+  printf("\nlevel   reached   cleared   won       win rate   deaths   deaths / attempt\n");
+  for (byte level = 1; level <= simulationLevels; level++) {
+    double deathRate = stats.reached[level] ? (double) stats.deaths[level] / stats.reached[level] : 0;
+
+    printf("%-7u %-9lu %-9lu %-9lu %6.2f %%   %-8lu %.3f\n", level, stats.reached[level], stats.cleared[level],
+           stats.won[level], 100.0 * stats.winRate(level), stats.deaths[level], deathRate);
+  }
+  printf("(a level is won when it is cleared without being caught on it)\n");
+}
+
+void printEscapeTimes(const std::vector<GameResult> &results, unsigned long timeLimit){
+  std::vector<unsigned long> times;
+  for (const GameResult &result : results) {
+    if (result.won) {
+      times.push_back(result.endTime);
+    }
+  }
+
+  if (times.empty()) {
+    printf("\nno escapes, no time distribution\n");
+    return;
+  }
+
+  std::sort(times.begin(), times.end());
+
+  unsigned long long total = 0;
+  for (unsigned long time : times) {
+    total += time;
+  }
+
+  printf("\ntime to escape (s): min %.1f  p10 %.1f  p25 %.1f  median %.1f  p75 %.1f  p90 %.1f  max %.1f  mean %.1f\n",
+         times.front() / 1000.0, percentile(times, 10) / 1000.0, percentile(times, 25) / 1000.0,
+         percentile(times, 50) / 1000.0, percentile(times, 75) / 1000.0, percentile(times, 90) / 1000.0,
+         times.back() / 1000.0, total / 1000.0 / times.size());
+
+  unsigned int bucketsCount = timeLimit / 1000 / histogramBucketSeconds + 1;
+  std::vector<unsigned long> buckets(bucketsCount, 0);
+  for (unsigned long time : times) {
+    buckets[std::min<unsigned long>(bucketsCount - 1, time / 1000 / histogramBucketSeconds)] += 1;
+  }
+
+  // only print the buckets between the first and the last used one
+  unsigned int first = 0, last = bucketsCount - 1;
+  while (buckets[first] == 0) first++;
+  while (buckets[last] == 0) last--;
+
+  unsigned long highest = *std::max_element(buckets.begin(), buckets.end());
+  for (unsigned int bucket = first; bucket <= last; bucket++) {
+    unsigned int width = (unsigned int) (buckets[bucket] * histogramBarWidth / highest);
+
+    printf("  %4u-%-4us %8lu |", bucket * histogramBucketSeconds, (bucket + 1) * histogramBucketSeconds, buckets[bucket]);
+    for (unsigned int i = 0; i < width; i++) {
+      putchar('#');
+    }
+    putchar('\n');
+  }
+}
+
+/*
+  For every level with deaths, print the four rooms side by side:
+  walls are '#', cells without deaths are '.', and the other
+  cells get a digit from 1 to 9, relative to the deadliest cell.
+*/
+void printDeathHeatmaps(const std::vector<GameResult> &results){
+  static unsigned long heatmap[simulationLevels + 1][roomsSize][matrixSize][matrixSize];
+  memset(heatmap, 0, sizeof(heatmap));
+
+  for (const GameResult &result : results) {
+    for (byte death = 0; death < result.deaths; death++) {
+      heatmap[result.deathLevel[death]][result.deathRoom[death]][result.deathRow[death]][result.deathColumn[death]] += 1;
+    }
+  }
+
+  for (byte level = 1; level <= simulationLevels; level++) {
+    unsigned long highest = 0, total = 0;
+    for (byte room = 0; room < roomsSize; room++) {
+      for (byte row = 0; row < matrixSize; row++) {
+        for (byte column = 0; column < matrixSize; column++) {
+          highest = std::max(highest, heatmap[level][room][row][column]);
+          total += heatmap[level][room][row][column];
+        }
+      }
+    }
+
+    if (total == 0) {
+      continue;
+    }
+
+    printf("\ndeath heatmap, level %u (%lu deaths, deadliest cell %lu)\n", level, total, highest);
+    printf("  room 0     room 1     room 2     room 3\n");
+
+    for (byte row = 0; row < matrixSize; row++) {
+      printf("  ");
+      for (byte room = 0; room < roomsSize; room++) {
+        for (byte column = 0; column < matrixSize; column++) {
+          unsigned long count = heatmap[level][room][row][column];
+
+          if (rooms[room][row][column]) {
+            putchar('#');
+          } else if (count == 0) {
+            putchar('.');
+          } else {
+            putchar('0' + (char) (1 + (count - 1) * 9 / highest));
+          }
+        }
+        printf("   ");
+      }
+      putchar('\n');
+    }
+  }
+}
+
+int main(int argc, char **argv){
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    return 1;
+  }
+
+  WorkStealingPool pool(options.threads);
+  std::vector<GameResult> results(options.games);
+
+  auto start = std::chrono::steady_clock::now();
+
+  pool.parallelFor(options.games, 256, [&](size_t index) {
+    results[index] = simulateGame(mixSeed(options.seed, index), options.config);
+  });
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  unsigned long won = 0, timedOut = 0;
+  for (const GameResult &result : results) {
+    won += result.won;
+    timedOut += result.timedOut;
+  }
+
+  unsigned long games = std::max(1UL, options.games);
+  printf("%lu games, seed %llu, %u threads, %.2f s (%.0f games/s)\n",
+         options.games, (unsigned long long) options.seed, pool.threads, seconds, options.games / seconds);
+  printf("bot: move every %u ms, %u %% mistakes, step %u ms\n",
+         options.config.moveInterval, options.config.mistakeChance, options.config.dt);
+  printf("\nwin rate %.2f %%  (caught %.2f %%, timed out %.2f %%)\n",
+         100.0 * won / games, 100.0 * (options.games - won - timedOut) / games, 100.0 * timedOut / games);
+
+  printLevels(results);
+  printEscapeTimes(results, options.config.timeLimit);
+  printDeathHeatmaps(results);
+
+  return 0;
+}
@@ -0,0 +1,391 @@
+/*
+  Sinister Escape - par time solver
+
+  For a seed, finds the fastest possible escape: a breadth first
+  search over every move the player can make (up, down, left,
+  right or waiting), on the same rules as the board, stepped
+  every gameStepInterval like the board. The moves come as fast
+  as a held joystick repeats them at its fastest (JoyStick.h),
+  which is also about as fast as the stick can be flicked.
+
+  A state of the search is the player (cell, room, notes, lives),
+  the note's cell, Dr. Nocturne (cell, waiting / chasing, time
+  since his last move) and how far the random generator went,
+  packed in 52 bits. States are only expanded the first time they
+  are reached, which also merges all the paths leading to them.
+
+  With --seeds, the par times are written as ParTimes.h, so the
+  board can play those seeds and show how far from par the
+  player escaped.
+
+  Build & run, from the repository root:
+    g++ -O2 -std=c++17 -pthread tools/ParSolver.cpp -o parsolver
+    ./parsolver --seed 12345
+    ./parsolver --seeds 32 --output ParTimes.h
+
+  Options:
+    --seed S            solve a single seed
+    --seeds N           solve N seeds derived from --base and write them
+    --base B            base of the derived seeds (1)
+    --threads T         worker threads, 0 for every core (0)
+    --move-interval MS  time between two moves of the player (150)
+    --dt MS             game time advanced by every step (10)
+    --output FILE       generated header (ParTimes.h)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../ConstantsJoystick.h"
+#include "Simulation.h"
+#include "WorkStealingPool.h"
+
+// random numbers a game can draw before the search gives up
+const unsigned int maximumDraws = 4096;
+// the search gives up on games longer than this, in ms
+const unsigned long solverTimeLimit = 900000UL;
+
+struct SolverConfig{
+  unsigned int moveInterval;
+  unsigned int dt;
+
+  SolverConfig(): moveInterval(joystickRepeatFastestInterval), dt(gameStepInterval) {}
+};
+
+struct Solution{
+  uint32_t seed;
+  bool solved;
+  // game time of the fastest escape, in ms
+  unsigned long parTime;
+  unsigned long statesExplored;
+  double seconds;
+};
+
+/*
+  Open addressing set of encoded states.
+*/
+struct StateSet{
+  std::vector<uint64_t> slots;
+  size_t count;
+
+  StateSet(): slots(1 << 16, 0), count(0) {}
+
+  static uint64_t hash(uint64_t key){
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    return key;
+  }
+
+  // returns false if the key was already in the set
+  bool insert(uint64_t key){
+    if ((count + 1) * 2 > slots.size()) {
+      grow();
+    }
+
+    // 0 marks an empty slot, so store the key shifted by one
+    key += 1;
+    size_t mask = slots.size() - 1;
+    for (size_t slot = hash(key) & mask; ; slot = (slot + 1) & mask) {
+      if (slots[slot] == key) {
+        return false;
+      }
+
+      if (slots[slot] == 0) {
+        slots[slot] = key;
+        count += 1;
+        return true;
+      }
+    }
+  }
+
+  void grow(){
+    std::vector<uint64_t> old(slots.size() * 2, 0);
+    old.swap(slots);
+
+    size_t mask = slots.size() - 1;
+    for (uint64_t key : old) {
+      if (key == 0) {
+        continue;
+      }
+
+      size_t slot = hash(key) & mask;
+      while (slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot] = key;
+    }
+  }
+};
+
+/*
+  Position of every state of the random generator in the sequence
+  of the seed, so a state can store how many numbers were drawn
+  instead of the whole 32 bit generator.
+*/
+struct DrawIndex{
+  std::vector<std::pair<uint32_t, uint16_t> > states;
+
+  void build(uint32_t seed){
+    GameRandom random;
+    random.seed(seed);
+
+    states.clear();
+    for (unsigned int draw = 0; draw < maximumDraws; draw++) {
+      states.push_back(std::make_pair(random.state, (uint16_t) draw));
+      random.next();
+    }
+    std::sort(states.begin(), states.end());
+  }
+
+  // returns maximumDraws for the states past the indexed ones
+  unsigned int find(uint32_t state) const{
+    std::vector<std::pair<uint32_t, uint16_t> >::const_iterator found =
+      std::lower_bound(states.begin(), states.end(), std::make_pair(state, (uint16_t) 0));
+
+    if (found == states.end() || found->first != state) {
+      return maximumDraws;
+    }
+    return found->second;
+  }
+};
+
+unsigned int cellOf(byte room, byte row, byte column){
+  return cellIndex(room, row, column);
+}
+
+/*
+  Pack everything that changes the rest of the game into 52 bits:
+  player cell 8, notes 3, lives 2, note cell 8, Dr. cell 8,
+  waiting & chasing 2, Dr's time since the last move 9, draws 12.
+  The level follows from the notes, so it is not stored.
+*/
+bool encodeState(const GameState &state, const DrawIndex &draws, const SolverConfig &config, uint64_t &key){
+  unsigned int drawn = draws.find(state.random.state);
+  if (drawn >= maximumDraws) {
+    return false;
+  }
+
+  // the time since the Dr's last move only matters while he is chasing,
+  // and only until it reaches his cooldown
+  uint64_t phase = 0;
+  if (state.doctor.isChasing) {
+    phase = std::min<unsigned long>((state.now - state.doctor.lastMovement) / config.dt, 511);
+  }
+
+  key = cellOf(state.player.currentRoom, state.player.row, state.player.column);
+  key = (key << 3) | state.player.notes;
+  key = (key << 2) | state.player.lives;
+  key = (key << 8) | cellOf(state.note.currentRoom, state.note.row, state.note.column);
+  key = (key << 8) | cellOf(state.doctor.currentRoom, state.doctor.row, state.doctor.column);
+  key = (key << 1) | state.doctor.isWaiting;
+  key = (key << 1) | state.doctor.isChasing;
+  key = (key << 9) | phase;
+  key = (key << 12) | drawn;
+
+  return true;
+}
+
+/*
+  Point the joystick in the given direction for one move,
+  then let the game run until the next move is possible.
+  Returns false if the player ran out of lives.
+*/
+bool playMove(GameState &state, byte direction, const SolverConfig &config){
+  for (unsigned int elapsed = 0; elapsed < config.moveInterval && state.isRunning; elapsed += config.dt) {
+    step(state, GameInput(elapsed == 0 ? direction : joystickNone, false), config.dt);
+  }
+
+  return state.isRunning || state.player.isWinning;
+}
+
+Solution solveSeed(uint32_t seed, const SolverConfig &config){
+  auto start = std::chrono::steady_clock::now();
+
+  Solution solution = {};
+  solution.seed = seed;
+
+  DrawIndex draws;
+  draws.build(seed);
+
+  GameState initial;
+  initial.reset(seed);
+
+  StateSet visited;
+  std::vector<GameState> layer(1, initial), nextLayer;
+  uint64_t key;
+  encodeState(initial, draws, config, key);
+  visited.insert(key);
+
+  // every layer is one more move; an escape found in a layer is
+  // always faster than any escape of the following layers
+  while (!layer.empty() && !solution.solved) {
+    nextLayer.clear();
+
+    for (const GameState &state : layer) {
+      for (byte direction = 0; direction <= directions; direction++) {
+        GameState next = state;
+        if (!playMove(next, direction < directions ? direction : joystickNone, config)) {
+          continue;
+        }
+
+        if (next.player.isWinning) {
+          if (!solution.solved || next.now < solution.parTime) {
+            solution.parTime = next.now;
+          }
+          solution.solved = true;
+          continue;
+        }
+
+        if (next.now >= solverTimeLimit || !encodeState(next, draws, config, key)) {
+          continue;
+        }
+
+        if (visited.insert(key)) {
+          nextLayer.push_back(next);
+        }
+      }
+    }
+
+    layer.swap(nextLayer);
+  }
+
+  solution.statesExplored = visited.count;
+  solution.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return solution;
+}
+
+bool writeHeader(const std::string &path, const std::vector<Solution> &solutions, const SolverConfig &config){
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == NULL) {
+    return false;
+  }
+
+  fprintf(file,
+          "#pragma once\n"
+          "#ifndef PAR_TIMES_H\n"
+          "#define PAR_TIMES_H\n"
+          "\n"
+          "#include \"Platform.h\"\n"
+          "\n"
+          "/*\n"
+          "  Seeds the board picks its games from, each with the\n"
+          "  fastest possible escape for it, in ms of game time.\n"
+          "\n"
+          "  Generated by tools/ParSolver.cpp, do not edit by hand.\n"
+          "  One move every %u ms, game stepped every %u ms.\n"
+          "*/\n"
+          "\n"
+          "struct ParSeed{\n"
+          "  uint32_t seed;\n"
+          "  uint32_t parTime;\n"
+          "};\n"
+          "\n"
+          "const ParSeed parSeeds[] PROGMEM = {\n",
+          config.moveInterval, config.dt);
+
+  size_t written = 0;
+  for (const Solution &solution : solutions) {
+    if (solution.solved) {
+      fprintf(file, "  {0x%08XUL, %luUL},\n", solution.seed, solution.parTime);
+      written += 1;
+    }
+  }
+
+  fprintf(file,
+          "};\n"
+          "\n"
+          "const byte parSeedsSize = %zu;\n"
+          "\n"
+          "#endif\n",
+          written);
+
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char **argv){
+  SolverConfig config;
+  unsigned long seedsCount = 0;
+  uint64_t base = 1;
+  uint32_t singleSeed = 0;
+  unsigned int threads = 0;
+  std::string outputPath = "ParTimes.h";
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      fprintf(stderr, "missing value for %s\n", argv[i]);
+      return 1;
+    }
+
+    const char *name = argv[i];
+    const char *value = argv[++i];
+
+    if (strcmp(name, "--seed") == 0) {
+      singleSeed = (uint32_t) strtoul(value, NULL, 0);
+    } else if (strcmp(name, "--seeds") == 0) {
+      seedsCount = strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--base") == 0) {
+      base = strtoull(value, NULL, 10);
+    } else if (strcmp(name, "--threads") == 0) {
+      threads = (unsigned int) strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--move-interval") == 0) {
+      config.moveInterval = (unsigned int) strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--dt") == 0) {
+      config.dt = (unsigned int) strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--output") == 0) {
+      outputPath = value;
+    } else {
+      fprintf(stderr, "unknown option %s %s\n", name, value);
+      return 1;
+    }
+  }
+
+  if (config.dt == 0 || config.moveInterval < config.dt || (singleSeed == 0 && seedsCount == 0)) {
+    fprintf(stderr, "usage: parsolver --seed S | --seeds N [--output ParTimes.h]\n");
+    return 1;
+  }
+
+  std::vector<uint32_t> seeds;
+  if (singleSeed != 0) {
+    seeds.push_back(singleSeed);
+  }
+  for (unsigned long index = 0; index < seedsCount; index++) {
+    // 0 is not a valid xorshift seed, skip it
+    uint32_t seed = (uint32_t) mixSeed(base, index);
+    seeds.push_back(seed != 0 ? seed : 1);
+  }
+
+  std::vector<Solution> solutions(seeds.size());
+  WorkStealingPool pool(threads);
+  pool.parallelFor(seeds.size(), 1, [&](size_t index) {
+    solutions[index] = solveSeed(seeds[index], config);
+  });
+
+  for (const Solution &solution : solutions) {
+    if (solution.solved) {
+      printf("seed 0x%08X  par %6.2f s  %8lu states  %.3f s\n",
+             solution.seed, solution.parTime / 1000.0, solution.statesExplored, solution.seconds);
+    } else {
+      printf("seed 0x%08X  no escape found  %8lu states  %.3f s\n",
+             solution.seed, solution.statesExplored, solution.seconds);
+    }
+  }
+
+  if (seedsCount > 0) {
+    if (!writeHeader(outputPath, solutions, config)) {
+      fprintf(stderr, "cannot write %s\n", outputPath.c_str());
+      return 1;
+    }
+    printf("written to %s\n", outputPath.c_str());
+  }
+
+  return 0;
+}
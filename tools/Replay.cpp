@@ -0,0 +1,289 @@
+/*
+  Sinister Escape - input replay
+
+  Runs the whole sketch on the host, on the emulated LCD, matrix
+  and EEPROM of tools/host, and feeds it a recorded run: every
+  recorded input goes into Menu::menuSwitch() at the ms it was
+  recorded at, with the board's random generator seeded like
+  on the board. The time only moves when the host says so, so
+  the replay runs as fast as the host can go.
+
+  After every loop, the content of the LCD and of the matrix is
+  hashed. The hash of all the frames is the signature of the
+  run: the same recording always gives the same signature, so
+  it works as a regression test and as a benchmark.
+
+  A run is recorded on the board by setting isRecordingInput
+  in InputRecorder.h and saving what comes over the serial
+  port, or generated here with --generate.
+
+  The replay runs the menu every --tick ms, like the board's
+  menu task does; a frame late on the board can still make a
+  game replayed from it drift from what happened there, while
+  replays on the host always match each other.
+
+  Build & run, from the repository root:
+    g++ -O2 -std=c++17 -Itools/host tools/Replay.cpp -o replay
+    ./replay --generate run.bin --seed 7 --length 600
+    ./replay --input run.bin --hashes frames.txt
+
+  Options:
+    --input FILE     recorded run to replay
+    --generate FILE  write a run of random input instead, then replay it
+    --seed S         seed of the generated run (1)
+    --length S       length of the generated run, in seconds (600)
+    --tick MS        time between two frames (menuTaskPeriod, 16)
+    --tail MS        time the replay goes on after the last input (10000)
+    --hashes FILE    write the time and hash of every frame that changed
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../SinisterEscape.ino"
+
+// shortest and longest pause between two generated inputs, in ms
+const unsigned long generatedMinimumPause = 80;
+const unsigned long generatedMaximumPause = 900;
+// chance, in percents, of a generated input being a switch press
+const byte generatedPressChance = 12;
+
+struct ReplayOptions{
+  std::string inputPath;
+  std::string generatePath;
+  std::string hashesPath;
+  uint32_t seed;
+  unsigned long length;
+  unsigned long tick;
+  unsigned long tail;
+
+  ReplayOptions(): seed(1), length(600), tick(menuTaskPeriod), tail(10000) {}
+};
+
+bool parseOptions(int argc, char **argv, ReplayOptions &options){
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      fprintf(stderr, "missing value for %s\n", argv[i]);
+      return false;
+    }
+
+    const char *name = argv[i];
+    const char *value = argv[++i];
+
+    if (strcmp(name, "--input") == 0) {
+      options.inputPath = value;
+    } else if (strcmp(name, "--generate") == 0) {
+      options.generatePath = value;
+    } else if (strcmp(name, "--hashes") == 0) {
+      options.hashesPath = value;
+    } else if (strcmp(name, "--seed") == 0) {
+      options.seed = (uint32_t) strtoul(value, NULL, 0);
+    } else if (strcmp(name, "--length") == 0) {
+      options.length = strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--tick") == 0 && strtoul(value, NULL, 10) > 0) {
+      options.tick = strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--tail") == 0) {
+      options.tail = strtoul(value, NULL, 10);
+    } else {
+      fprintf(stderr, "unknown option %s %s\n", name, value);
+      return false;
+    }
+  }
+
+  if (options.inputPath.empty() == options.generatePath.empty()) {
+    fprintf(stderr, "usage: replay --input FILE | --generate FILE [--hashes FILE]\n");
+    return false;
+  }
+
+  return true;
+}
+
+/*
+  A run of random input: the joystick pushed in random
+  directions, with a press every now and then to move
+  through the menus, pause and start new games.
+*/
+std::vector<byte> generateRun(uint32_t seed, unsigned long length){
+  GameRandom random;
+  random.seed(seed);
+
+  std::vector<byte> run(inputLogHeaderSize);
+  InputLogWriter writer;
+  writer.header(seed, run.data());
+
+  byte bytes[inputLogRecordMaximumSize];
+  unsigned long time = 1000;
+
+  while (time < length * 1000) {
+    bool isPressed = random.below(100) < generatedPressChance;
+    byte event = encodeInputEvent(isPressed ? joystickNone : random.below(directions), isPressed);
+
+    byte size = writer.record(time, event, bytes);
+    run.insert(run.end(), bytes, bytes + size);
+
+    time += generatedMinimumPause + random.next() % (generatedMaximumPause - generatedMinimumPause);
+  }
+
+  return run;
+}
+
+bool readFile(const std::string &path, std::vector<byte> &bytes){
+  FILE *file = fopen(path.c_str(), "rb");
+  if (file == NULL) {
+    return false;
+  }
+
+  byte buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    bytes.insert(bytes.end(), buffer, buffer + size);
+  }
+
+  fclose(file);
+  return true;
+}
+
+bool writeFile(const std::string &path, const std::vector<byte> &bytes){
+  FILE *file = fopen(path.c_str(), "wb");
+  if (file == NULL) {
+    return false;
+  }
+
+  size_t written = fwrite(bytes.data(), 1, bytes.size(), file);
+  fclose(file);
+  return written == bytes.size();
+}
+
+uint64_t hashBytes(uint64_t hash, const void *data, size_t size){
+  const byte *bytes = (const byte *) data;
+
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+/*
+  FNV-1a of what can be seen: the 16 visible characters of
+  both LCD lines, its cursor, and the matrix.
+*/
+uint64_t hashFrame(const Menu &menu){
+  uint64_t hash = 0xCBF29CE484222325ULL;
+
+  for (byte line = 0; line < 2; line++) {
+    hash = hashBytes(hash, menu.lcd.lines[line], 16);
+  }
+
+  byte cursor[4] = {menu.lcd.column, menu.lcd.line, menu.lcd.isCursorVisible, menu.lcd.isBlinking};
+  hash = hashBytes(hash, cursor, sizeof(cursor));
+
+  hash = hashBytes(hash, menu.lc.rows, sizeof(menu.lc.rows));
+  byte matrix[2] = {menu.lc.intensity, menu.lc.isShutdown};
+  return hashBytes(hash, matrix, sizeof(matrix));
+}
+
+int main(int argc, char **argv){
+  ReplayOptions options;
+  if (!parseOptions(argc, argv, options)) {
+    return 1;
+  }
+
+  std::vector<byte> run;
+  if (!options.generatePath.empty()) {
+    run = generateRun(options.seed, options.length);
+
+    if (!writeFile(options.generatePath, run)) {
+      fprintf(stderr, "cannot write %s\n", options.generatePath.c_str());
+      return 1;
+    }
+  } else if (!readFile(options.inputPath, run)) {
+    fprintf(stderr, "cannot read %s\n", options.inputPath.c_str());
+    return 1;
+  }
+
+  InputLogReader reader(run.data(), run.size());
+  if (!reader.begin()) {
+    fprintf(stderr, "no recorded run found\n");
+    return 1;
+  }
+
+  FILE *hashes = NULL;
+  if (!options.hashesPath.empty()) {
+    hashes = fopen(options.hashesPath.c_str(), "w");
+    if (hashes == NULL) {
+      fprintf(stderr, "cannot write %s\n", options.hashesPath.c_str());
+      return 1;
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  setup();
+  // pick the same games as the board did
+  boardRandom.seed(reader.seed);
+
+  unsigned long recordTime = 0, inputs = 0, frames = 0, changes = 0;
+  byte event = 0;
+  bool hasRecord = reader.next(recordTime, event);
+  unsigned long endTime = 0;
+
+  uint64_t signature = 0xCBF29CE484222325ULL;
+  uint64_t lastHash = 0;
+
+  while (hasRecord || millis() < endTime) {
+    hostMicros() += options.tick * 1000ULL;
+    tickNow = millis();
+
+    // the inputs of this frame, one per frame like on the board
+    joystick.direction = joystickNone;
+    joystick.currentSwitchStateChanged = LOW;
+
+    if (hasRecord && recordTime <= millis()) {
+      bool isPressed;
+      decodeInputEvent(event, joystick.direction, isPressed);
+      joystick.currentSwitchStateChanged = isPressed ? HIGH : LOW;
+      inputs += 1;
+
+      hasRecord = reader.next(recordTime, event);
+      if (!hasRecord) {
+        endTime = millis() + options.tail;
+      }
+    }
+
+    menu.menuSwitch(joystick);
+    // the host's µs stand still, so every job finishes in one slice
+    jobsTask(millis());
+
+    uint64_t hash = hashFrame(menu);
+    signature = hashBytes(signature, &hash, sizeof(hash));
+    frames += 1;
+
+    if (hash != lastHash) {
+      changes += 1;
+      lastHash = hash;
+
+      if (hashes != NULL) {
+        fprintf(hashes, "%lu %016llx\n", millis(), (unsigned long long) hash);
+      }
+    }
+  }
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (hashes != NULL) {
+    fclose(hashes);
+  }
+
+  printf("seed 0x%08X, %lu inputs, %lu frames (%lu changed), %.1f s of board time\n",
+         reader.seed, inputs, frames, changes, millis() / 1000.0);
+  printf("signature %016llx\n", (unsigned long long) signature);
+  printf("%.3f s, %.0f frames/s\n", seconds, frames / seconds);
+
+  return 0;
+}
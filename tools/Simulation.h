@@ -0,0 +1,146 @@
+#pragma once
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stdint.h>
+
+#include "../ConstantsJoystick.h"
+#include "../GameState.h"
+#include "../Bot.h"
+
+// number of levels Dr. Nocturne goes through
+const byte simulationLevels = 3;
+
+struct SimulationConfig{
+  // game time advanced by every step, in ms; the board's by default
+  unsigned int dt;
+  // minimum time between two bot movements: by default, how
+  // often a held joystick repeats before it speeds up
+  unsigned int moveInterval;
+  // chance, in percents, of a bot movement being random
+  byte mistakeChance;
+  // games still running after this many ms are stopped
+  unsigned long timeLimit;
+
+  SimulationConfig(): dt(gameStepInterval), moveInterval(joystickRepeatInterval), mistakeChance(10), timeLimit(900000UL) {}
+};
+
+struct GameResult{
+  bool won;
+  bool timedOut;
+  // game time when the game ended, in ms
+  unsigned long endTime;
+  // highest level reached during the game
+  byte levelReached;
+
+  // where and on which level the player lost every life
+  byte deaths;
+  byte deathLevel[3];
+  byte deathRoom[3];
+  byte deathRow[3];
+  byte deathColumn[3];
+};
+
+/*
+  Mix the sweep seed with the index of a game, so every
+  game gets its own seed no matter which thread plays it.
+*/
+uint64_t mixSeed(uint64_t seed, uint64_t index){
+  uint64_t value = seed + 0x9E3779B97F4A7C15ULL * (index + 1);
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+/*
+  Play one whole game with the bot, from the given seed,
+  with Dr. Nocturne using the given chase parameters.
+*/
+GameResult simulateGame(uint64_t seed, const SimulationConfig &config, const DoctorTuning &tuning = defaultDoctorTuning){
+  GameResult result = {};
+
+  GameState state;
+  state.reset((uint32_t) seed);
+  state.doctor.tuning = &tuning;
+
+  Bot bot;
+  bot.reset((uint32_t) (seed >> 32), config.mistakeChance);
+
+  unsigned long nextMove = 0;
+
+  while (state.isRunning && state.now < config.timeLimit) {
+    byte direction = joystickNone;
+    if (state.now >= nextMove) {
+      direction = bot.chooseDirection(state);
+      nextMove = state.now + config.moveInterval;
+    }
+
+    byte level = state.doctor.level;
+    step(state, GameInput(direction, false), config.dt);
+
+    if ((state.events & eventPlayerDied) && result.deaths < 3) {
+      result.deathLevel[result.deaths] = level;
+      result.deathRoom[result.deaths] = state.player.currentRoom;
+      result.deathRow[result.deaths] = state.player.row;
+      result.deathColumn[result.deaths] = state.player.column;
+      result.deaths += 1;
+    }
+  }
+
+  result.won = state.player.isWinning;
+  result.timedOut = state.isRunning;
+  result.endTime = state.now;
+  result.levelReached = state.doctor.level;
+
+  return result;
+}
+
+/*
+  How the games went on every level:
+  -> reached: games that got to the level
+  -> cleared: games that moved on to the next level, or escaped
+  -> won: games that cleared the level without being caught on it
+*/
+struct LevelStats{
+  unsigned long reached[simulationLevels + 1];
+  unsigned long cleared[simulationLevels + 1];
+  unsigned long won[simulationLevels + 1];
+  unsigned long deaths[simulationLevels + 1];
+
+  LevelStats(){
+    for (byte level = 0; level <= simulationLevels; level++) {
+      reached[level] = 0;
+      cleared[level] = 0;
+      won[level] = 0;
+      deaths[level] = 0;
+    }
+  }
+
+  void add(const GameResult &result);
+  double winRate(byte level) const;
+};
+
+void LevelStats::add(const GameResult &result){
+  bool caught[simulationLevels + 1] = {};
+
+  for (byte death = 0; death < result.deaths; death++) {
+    deaths[result.deathLevel[death]] += 1;
+    caught[result.deathLevel[death]] = true;
+  }
+
+  for (byte level = 1; level <= result.levelReached; level++) {
+    reached[level] += 1;
+
+    // a level is cleared by moving to the next one, or by escaping
+    if (level < result.levelReached || result.won) {
+      cleared[level] += 1;
+      won[level] += !caught[level];
+    }
+  }
+}
+
+double LevelStats::winRate(byte level) const{
+  return reached[level] ? (double) won[level] / reached[level] : 0;
+}
+
+#endif
@@ -0,0 +1,167 @@
+/*
+  Sinister Escape - saved game check
+
+  Plays games with the bot and, wherever the board saves the game
+  (a note found, a life lost), packs it into a snapshot like
+  SavedGame.h does, unpacks it into a new game and plays both on
+  with the same moves. The continued game has to stay the same as
+  the one that was never saved, up to the end of the game or of
+  the time followed.
+
+  Build & run, from the repository root:
+    g++ -O2 -std=c++17 tools/SnapshotCheck.cpp -o snapshotcheck
+    ./snapshotcheck --games 300
+
+  Options:
+    --games N     number of games to play (300)
+    --seed S      seed of the games (1)
+    --follow MS   game time both games are played on for (20000)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Simulation.h"
+#include "../Snapshot.h"
+
+// par seed saved with the games, any value fits in the snapshot
+const byte checkedParSeed = 42;
+
+/*
+  Everything the rest of the game depends on. Dr. Nocturne's
+  time since his last move only matters up to what the snapshot
+  keeps of it, as his cooldowns are shorter.
+*/
+bool isSameGame(const GameState &a, const GameState &b){
+  const unsigned long maximumCooldown = (1UL << snapshotCooldownBits) - 1;
+  unsigned long sinceA = a.now - a.doctor.lastMovement;
+  unsigned long sinceB = b.now - b.doctor.lastMovement;
+
+  return a.player.currentRoom == b.player.currentRoom
+      && a.player.row == b.player.row
+      && a.player.column == b.player.column
+      && a.player.notes == b.player.notes
+      && a.player.lives == b.player.lives
+      && a.player.isWinning == b.player.isWinning
+      && a.note.currentRoom == b.note.currentRoom
+      && a.note.row == b.note.row
+      && a.note.column == b.note.column
+      && a.doctor.currentRoom == b.doctor.currentRoom
+      && a.doctor.row == b.doctor.row
+      && a.doctor.column == b.doctor.column
+      && a.doctor.isWaiting == b.doctor.isWaiting
+      && a.doctor.isChasing == b.doctor.isChasing
+      && a.doctor.level == b.doctor.level
+      && (sinceA < maximumCooldown ? sinceA : maximumCooldown) == (sinceB < maximumCooldown ? sinceB : maximumCooldown)
+      && a.now == b.now
+      && a.random.state == b.random.state
+      && a.isRunning == b.isRunning;
+}
+
+/*
+  Save the game, continue it from the snapshot, and play both
+  on with the bot. Returns false if they went apart.
+*/
+bool checkSave(const GameState &state, const Bot &bot, unsigned long nextMove,
+               const SimulationConfig &config, unsigned long follow){
+  GameSnapshot snapshot;
+  snapshot.pack(state, checkedParSeed);
+
+  GameState continued;
+  byte parSeed = 0;
+  if (!snapshot.unpack(continued, parSeed) || parSeed != checkedParSeed) {
+    return false;
+  }
+
+  // continued paused, the player presses to go on
+  continued.isInPause = state.isInPause;
+
+  GameState original = state;
+  Bot originalBot = bot, continuedBot = bot;
+  unsigned long end = state.now + follow;
+
+  while (original.isRunning && original.now < end) {
+    byte originalDirection = joystickNone, continuedDirection = joystickNone;
+
+    if (original.now >= nextMove) {
+      originalDirection = originalBot.chooseDirection(original);
+      continuedDirection = continuedBot.chooseDirection(continued);
+      nextMove = original.now + config.moveInterval;
+    }
+
+    step(original, GameInput(originalDirection, false), config.dt);
+    step(continued, GameInput(continuedDirection, false), config.dt);
+
+    if (!isSameGame(original, continued)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv){
+  unsigned long games = 300;
+  uint64_t seed = 1;
+  unsigned long follow = 20000;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      fprintf(stderr, "missing value for %s\n", argv[i]);
+      return 1;
+    }
+
+    const char *name = argv[i];
+    const char *value = argv[++i];
+
+    if (strcmp(name, "--games") == 0) {
+      games = strtoul(value, NULL, 10);
+    } else if (strcmp(name, "--seed") == 0) {
+      seed = strtoull(value, NULL, 10);
+    } else if (strcmp(name, "--follow") == 0) {
+      follow = strtoul(value, NULL, 10);
+    } else {
+      fprintf(stderr, "unknown option %s %s\n", name, value);
+      return 1;
+    }
+  }
+
+  SimulationConfig config;
+  unsigned long saves = 0, mismatches = 0;
+
+  for (unsigned long game = 0; game < games; game++) {
+    uint64_t gameSeed = mixSeed(seed, game);
+
+    GameState state;
+    state.reset((uint32_t) gameSeed);
+
+    Bot bot;
+    bot.reset((uint32_t) (gameSeed >> 32), config.mistakeChance);
+
+    unsigned long nextMove = 0;
+
+    while (state.isRunning && state.now < config.timeLimit) {
+      byte direction = joystickNone;
+      if (state.now >= nextMove) {
+        direction = bot.chooseDirection(state);
+        nextMove = state.now + config.moveInterval;
+      }
+
+      step(state, GameInput(direction, false), config.dt);
+
+      // the board saves the game at these moments
+      if (state.isRunning && (state.events & (eventNoteFound | eventPlayerDied))) {
+        saves += 1;
+
+        if (!checkSave(state, bot, nextMove, config, follow)) {
+          mismatches += 1;
+          printf("game %lu: the continued game went apart at %lu ms\n", game, state.now);
+        }
+      }
+    }
+  }
+
+  printf("%lu games, %lu saves continued, %lu went apart\n", games, saves, mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,436 @@
+/*
+  Sinister Escape - EEPROM wear simulation
+
+  Plays a long run of games against the table of highscores, the
+  store of Store.h and the saved games of SavedGame.h, on the
+  emulated EEPROM of tools/host, which counts the writes of every
+  cell: every game is saved a few times and forgotten once it
+  ends, the games that make the table are put in it, and now and
+  then a setting is changed and saved.
+  At the end, it reports how many times every cell was written,
+  next to what the saves of the store would have cost at the
+  fixed addresses used before it.
+
+  Some saves have the power cut in the middle of their writes; the
+  store is then loaded again, like after a reboot, and has to
+  give back the last record that was written whole: the one
+  before, or the new one if its last bytes were already there.
+  A CRC-8 lets about one torn record in 256 pass for a whole one,
+  so with many cuts a few records can be reported lost. After
+  every cut, the table has to hold the highscores from before
+  the save, or from after it, in their order, and the saved game
+  has to be the one before the cut snapshot or that one.
+
+  Before the games, the board boots on EEPROMs filled with random
+  bytes, like one another sketch used, and has to come back from
+  every one of them.
+
+  Build & run, from the repository root:
+    g++ -O2 -std=c++17 -Itools/host tools/StoreWear.cpp -o storewear
+    ./storewear --games 100000
+
+  Options:
+    --games N           number of games to play (100000)
+    --seed S            seed of the run (1)
+    --record-chance P   chance in percents of a game making the table (10)
+    --settings-every N  games between two changes of the settings (50)
+    --snapshots N       saves of the running game in every game (6)
+    --power-cuts P      chance in percents of a save being cut short (1)
+    --random-boots N    boots on random EEPROMs before the games (1000)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "../GameRandom.h"
+#include "../EepromSchema.h"
+#include "../SavedGame.h"
+
+// the EEPROM cells can be written about this many times
+const unsigned long eepromEndurance = 100000;
+// escape time of the first highscore, in centiseconds
+const unsigned long firstEscape = 60000;
+
+struct Options{
+  unsigned long games;
+  uint32_t seed;
+  byte recordChance;
+  unsigned long settingsEvery;
+  unsigned long snapshots;
+  byte powerCuts;
+  unsigned long randomBoots;
+
+  Options(): games(100000), seed(1), recordChance(10), settingsEvery(50), snapshots(6), powerCuts(1), randomBoots(1000) {}
+};
+
+bool parseOptions(int argc, char **argv, Options &options){
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      fprintf(stderr, "missing value for %s\n", argv[i]);
+      return false;
+    }
+
+    const char *name = argv[i];
+    unsigned long value = strtoul(argv[++i], NULL, 10);
+
+    if (strcmp(name, "--games") == 0) {
+      options.games = value;
+    } else if (strcmp(name, "--seed") == 0) {
+      options.seed = (uint32_t) value;
+    } else if (strcmp(name, "--record-chance") == 0 && value <= 100) {
+      options.recordChance = (byte) value;
+    } else if (strcmp(name, "--settings-every") == 0 && value > 0) {
+      options.settingsEvery = value;
+    } else if (strcmp(name, "--snapshots") == 0) {
+      options.snapshots = value;
+    } else if (strcmp(name, "--power-cuts") == 0 && value <= 100) {
+      options.powerCuts = (byte) value;
+    } else if (strcmp(name, "--random-boots") == 0) {
+      options.randomBoots = value;
+    } else {
+      fprintf(stderr, "unknown option %s %s\n", name, argv[i]);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+  The same save at fixed addresses, at the start of the EEPROM.
+*/
+void saveLegacy(HostEEPROM &legacy){
+  for (byte i = 0; i < storePayloadSize; i++) {
+    legacy.update(i, store.payload[i]);
+  }
+}
+
+// the payload of the last record written whole
+byte committed[storePayloadSize];
+bool hasCommitted = false;
+
+/*
+  Write the save that was asked for, and the highscore before
+  it, like the board's EEPROM interrupt would, a changed byte
+  at a time.
+  With a power cut, only part of the record gets written and
+  the store is loaded again, which has to find the last record
+  written whole. Returns false if it did not.
+*/
+bool finishSave(GameRandom &random, byte powerCuts, unsigned long &cuts){
+  byte saved[storePayloadSize];
+  memcpy(saved, store.payload, storePayloadSize);
+
+  if (random.below(100) >= powerCuts) {
+    store.flush();
+
+    memcpy(committed, saved, storePayloadSize);
+    hasCommitted = true;
+    return true;
+  }
+
+  // the bytes written before the power went away
+  byte written = random.below(storeSlotSize + highscoreSize);
+  for (byte i = 0; i < written; i++) {
+    eepromWriter.tick();
+  }
+  cuts += 1;
+
+  // the reboot
+  eepromWriter = EepromWriter();
+  store = Store();
+  if (!store.load()) {
+    return !hasCommitted;
+  }
+
+  loadPlayersHighschores();
+
+  bool isFound = memcmp(store.payload, saved, storePayloadSize) == 0
+              || (hasCommitted && memcmp(store.payload, committed, storePayloadSize) == 0);
+
+  memcpy(committed, store.payload, storePayloadSize);
+  hasCommitted = true;
+  return isFound;
+}
+
+/*
+  Save a game, a snapshot of random bytes, like the board
+  does at a pause, a note or a death. With a power cut, only
+  part of it gets written and the newest saved game is found
+  again, which has to be the one before or the new one.
+  Returns false if it was not.
+*/
+bool saveGame(GameRandom &random, byte powerCuts, unsigned long &cuts, GameSnapshot &last, bool &hasLast){
+  GameSnapshot snapshot;
+  snapshot.bytes[0] = snapshotVersion;
+  for (byte i = 1; i < snapshotSize - 1; i++) {
+    snapshot.bytes[i] = random.next();
+  }
+  snapshot.bytes[snapshotSize - 1] = crc8(snapshot.bytes, snapshotSize - 1);
+
+  writeSavedGame(snapshot);
+
+  if (random.below(100) >= powerCuts) {
+    eepromWriter.update();
+
+    last = snapshot;
+    hasLast = true;
+    return true;
+  }
+
+  // the bytes written before the power went away
+  byte written = random.below(savedGameSlotSize);
+  for (byte i = 0; i < written; i++) {
+    eepromWriter.tick();
+  }
+  cuts += 1;
+
+  // the reboot
+  eepromWriter = EepromWriter();
+  savedGameWriting = SavedGameWriting();
+  loadSavedGames();
+
+  GameSnapshot read;
+  bool hasRead = readSavedGame(read);
+  bool isFound = (hasRead && memcmp(read.bytes, snapshot.bytes, snapshotSize) == 0)
+              || (hasRead && hasLast && memcmp(read.bytes, last.bytes, snapshotSize) == 0)
+              || (!hasRead && !hasLast);
+
+  hasLast = hasRead;
+  last = read;
+  return isFound;
+}
+
+/*
+  The times the table should hold, fastest first, with the
+  same rules as the board: a time gets in while the table is
+  not full, or if it is faster than the slowest one.
+*/
+struct ExpectedTable{
+  std::vector<unsigned long> times;
+
+  void insert(unsigned long time);
+  bool matches() const;
+};
+
+void ExpectedTable::insert(unsigned long time){
+  if (times.size() == maximumHighscores && time >= times.back()) {
+    return;
+  }
+
+  times.insert(std::upper_bound(times.begin(), times.end(), time), time);
+  if (times.size() > maximumHighscores) {
+    times.pop_back();
+  }
+}
+
+/*
+  Returns true if the table, as the board loaded it,
+  holds the times, in their order.
+*/
+bool ExpectedTable::matches() const{
+  if (highscoresRegistered != times.size()) {
+    return false;
+  }
+
+  unsigned long slowest = times.empty() ? highscoreDefaultValue : times.back();
+  if (slowestHighscore != slowest) {
+    return false;
+  }
+
+  for (byte index = 0; index < times.size(); index++) {
+    if (readHighscoreTime(index) != times[index]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+  Boot on EEPROMs filled with random bytes: the boot has to
+  return, with the defaults or with a record the bytes happen
+  to hold. Returns how many boots found such a record.
+*/
+unsigned long bootRandomEeproms(GameRandom &random, unsigned long boots){
+  unsigned long records = 0;
+
+  for (unsigned long boot = 0; boot < boots; boot++) {
+    for (int address = 0; address < EEPROM.length(); address++) {
+      EEPROM.bytes[address] = random.next();
+    }
+
+    eepromWriter = EepromWriter();
+    store = Store();
+    if (readSchemaVersion() != schemaUnknown) {
+      records += 1;
+    }
+
+    loadEeprom();
+    loadPlayersHighschores();
+    loadSavedGames();
+
+    GameSnapshot snapshot;
+    readSavedGame(snapshot);
+  }
+
+  EEPROM = HostEEPROM();
+  eepromWriter = EepromWriter();
+  store = Store();
+  savedGameWriting = SavedGameWriting();
+  return records;
+}
+
+/*
+  Print the least, average and most writes of the cells
+  of the area. Returns the most.
+*/
+unsigned long printWear(const char *name, int start, int end){
+  unsigned long least = 0xFFFFFFFFUL, most = 0, total = 0;
+  int hottest = start;
+
+  for (int address = start; address < end; address++) {
+    unsigned long writes = EEPROM.writes[address];
+    total += writes;
+
+    if (writes < least) {
+      least = writes;
+    }
+    if (writes > most) {
+      most = writes;
+      hottest = address;
+    }
+  }
+
+  printf("%s at %d..%d: writes per cell min %lu, avg %.1f, max %lu (cell %d)\n",
+         name, start, end - 1, least, (double) total / (end - start), most, hottest);
+  return most;
+}
+
+int main(int argc, char **argv){
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    return 1;
+  }
+
+  GameRandom random;
+  random.seed(options.seed);
+
+  unsigned long randomRecords = bootRandomEeproms(random, options.randomBoots);
+  printf("%lu boots on random EEPROMs, all came back, %lu took a layout from the bytes\n",
+         options.randomBoots, randomRecords);
+
+  HostEEPROM legacy;
+  unsigned long saves = 0, cuts = 0, lostRecords = 0, brokenTables = 0;
+  unsigned long gameSaves = 0, gameCuts = 0, lostGames = 0;
+  ExpectedTable table;
+  GameSnapshot lastGame;
+  bool hasLastGame = false;
+
+  store.load();
+  loadPlayersHighschores();
+  loadSavedGames();
+
+  for (unsigned long game = 1; game <= options.games; game++) {
+    for (unsigned long i = 0; i < options.snapshots; i++) {
+      gameSaves += 1;
+      if (!saveGame(random, options.powerCuts, gameCuts, lastGame, hasLastGame)) {
+        lostGames += 1;
+      }
+    }
+
+    // the game ended, nothing is left to continue
+    clearSavedGame();
+    eepromWriter.update();
+    GameSnapshot snapshot;
+    if (readSavedGame(snapshot)) {
+      lostGames += 1;
+    }
+    hasLastGame = false;
+
+    ExpectedTable before = table;
+    bool isRecord = random.below(100) < options.recordChance;
+    bool changesSettings = game % options.settingsEvery == 0;
+
+    if (changesSettings) {
+      store.payload[random.below(3)] = random.below(16);
+    }
+
+    if (isRecord) {
+      // a time landing at a random place of the table, just
+      // before the highscore there, or after the slowest one
+      byte places = highscoresRegistered < maximumHighscores ? highscoresRegistered + 1 : maximumHighscores;
+      byte place = random.below(places);
+      unsigned long time = place < highscoresRegistered ? readHighscoreTime(place) - 1
+                         : highscoresRegistered > 0 ? slowestHighscore + 1 : firstEscape;
+      char name[playerNameSize] = {(char) ('A' + random.below(26)), (char) ('A' + random.below(26)), (char) ('A' + random.below(26))};
+
+      updateHighscores(time, name);
+      table.insert(time);
+    } else if (changesSettings) {
+      store.save();
+    } else {
+      continue;
+    }
+
+    saveLegacy(legacy);
+    saves += 1;
+
+    unsigned long cutsBefore = cuts;
+    if (!finishSave(random, options.powerCuts, cuts)) {
+      lostRecords += 1;
+    }
+
+    if (cuts > cutsBefore) {
+      // the highscore is lost with the save that was cut
+      if (before.matches()) {
+        table = before;
+      } else if (!table.matches()) {
+        brokenTables += 1;
+        table.times.clear();
+        for (byte index = 0; index < highscoresRegistered; index++) {
+          table.times.push_back(readHighscoreTime(index));
+        }
+      }
+    }
+  }
+
+  unsigned long legacyMost = 0;
+  for (int address = 0; address < storePayloadSize; address++) {
+    if (legacy.writes[address] > legacyMost) {
+      legacyMost = legacy.writes[address];
+    }
+  }
+
+  printf("%lu games, %lu saves, %lu cut short, %lu records lost, %lu tables broken\n",
+         options.games, saves, cuts, lostRecords, brokenTables);
+  printf("%lu games saved, %lu cut short, %lu saved games lost\n", gameSaves, gameCuts, lostGames);
+
+  unsigned long most = 0;
+  most = max(most, printWear("highscores", highscoresStartAddr, storeStartAddr));
+  most = max(most, printWear("store", storeStartAddr, storeStartAddr + storeSlots * storeSlotSize));
+  most = max(most, printWear("saved games", savedGameStartAddr, savedGameStartAddr + savedGameSlots * savedGameSlotSize));
+  printf("store at fixed addresses: max %lu writes per cell\n", legacyMost);
+
+  printf("\nwrites per cell, 32 cells per line:\n");
+  for (int line = highscoresStartAddr; line < EEPROM.length(); line += 32) {
+    printf("%4d:", line);
+    for (int address = line; address < line + 32 && address < EEPROM.length(); address++) {
+      printf(" %lu", EEPROM.writes[address]);
+    }
+    printf("\n");
+  }
+
+  if (most > 0) {
+    printf("\ngames until a cell wears out (%lu writes): %.0f\n", eepromEndurance,
+           (double) options.games * eepromEndurance / most);
+  }
+
+  return 0;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+  Runs a loop body over an index range on every CPU core.
+
+  The range is cut into chunks that are dealt to the workers'
+  own deques. A worker takes its chunks from the back of its
+  deque and, once it runs dry, steals chunks from the front of
+  the other deques, so slow chunks never leave cores idle.
+
+  The body only receives indices, so writing the result of every
+  index into its own slot keeps the output independent of which
+  worker ran what.
+*/
+struct WorkStealingPool{
+  struct Chunk{
+    size_t begin;
+    size_t end;
+  };
+
+  struct Worker{
+    std::mutex lock;
+    std::deque<Chunk> chunks;
+  };
+
+  unsigned int threads;
+
+  explicit WorkStealingPool(unsigned int threads = 0){
+    this->threads = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  template <typename Body>
+  void parallelFor(size_t count, size_t chunkSize, Body body);
+
+  static bool takeOwn(Worker &worker, Chunk &chunk);
+  static bool steal(Worker &victim, Chunk &chunk);
+};
+
+bool WorkStealingPool::takeOwn(Worker &worker, Chunk &chunk){
+  std::lock_guard<std::mutex> guard(worker.lock);
+  if (worker.chunks.empty()) {
+    return false;
+  }
+
+  chunk = worker.chunks.back();
+  worker.chunks.pop_back();
+  return true;
+}
+
+bool WorkStealingPool::steal(Worker &victim, Chunk &chunk){
+  std::lock_guard<std::mutex> guard(victim.lock);
+  if (victim.chunks.empty()) {
+    return false;
+  }
+
+  chunk = victim.chunks.front();
+  victim.chunks.pop_front();
+  return true;
+}
+
+/*
+  Call body(index) for every index in [0, count) and
+  return once all of them have finished.
+*/
+template <typename Body>
+void WorkStealingPool::parallelFor(size_t count, size_t chunkSize, Body body){
+  chunkSize = std::max<size_t>(1, chunkSize);
+  unsigned int workersCount = (unsigned int) std::min<size_t>(threads, (count + chunkSize - 1) / chunkSize);
+
+  if (workersCount <= 1) {
+    for (size_t index = 0; index < count; index++) {
+      body(index);
+    }
+    return;
+  }
+
+  // deal the chunks round robin, so every worker starts
+  // with a slice of the whole range
+  std::vector<Worker> workers(workersCount);
+  size_t dealt = 0;
+  for (size_t begin = 0; begin < count; begin += chunkSize) {
+    Chunk chunk = {begin, std::min(count, begin + chunkSize)};
+    workers[dealt % workersCount].chunks.push_back(chunk);
+    dealt += 1;
+  }
+
+  auto run = [&](unsigned int self) {
+    Chunk chunk;
+
+    while (true) {
+      bool found = takeOwn(workers[self], chunk);
+
+      // nothing left in the own deque, look for work in the others
+      for (unsigned int offset = 1; !found && offset < workersCount; offset++) {
+        found = steal(workers[(self + offset) % workersCount], chunk);
+      }
+
+      // every deque is empty and nothing is ever pushed back,
+      // so the work is done
+      if (!found) {
+        return;
+      }
+
+      for (size_t index = chunk.begin; index < chunk.end; index++) {
+        body(index);
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned int worker = 1; worker < workersCount; worker++) {
+    pool.emplace_back(run, worker);
+  }
+  run(0);
+
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+}
+
+#endif
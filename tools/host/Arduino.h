@@ -0,0 +1,89 @@
+#pragma once
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+  Just enough of the Arduino core to run the sketch on the host:
+  the time is a counter the host tool moves forward, the pins
+  read as an untouched joystick and the serial port is muted.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+
+#define A0 14
+#define A1 15
+
+#define F(string) (string)
+#define digitalPinToInterrupt(pin) ((pin) == 2 ? 0 : ((pin) == 3 ? 1 : -1))
+
+// current time of the host's board, in µs
+inline unsigned long long &hostMicros(){
+  static unsigned long long time = 0;
+  return time;
+}
+
+inline unsigned long millis(){ return (unsigned long) (hostMicros() / 1000); }
+inline unsigned long micros(){ return (unsigned long) hostMicros(); }
+inline void delay(unsigned long ms){ hostMicros() += ms * 1000ULL; }
+inline void delayMicroseconds(unsigned int us){ hostMicros() += us; }
+
+inline long random(long maximum){ return maximum > 0 ? rand() % maximum : 0; }
+inline long random(long minimum, long maximum){ return minimum + random(maximum - minimum); }
+inline void randomSeed(unsigned long seed){ srand((unsigned int) seed); }
+
+// the joystick rests in the middle, with its switch released
+inline int analogRead(int){ return 512; }
+inline int digitalRead(int){ return HIGH; }
+inline void pinMode(int, int){}
+inline void digitalWrite(int, int){}
+inline void analogWrite(int, int){}
+
+inline void tone(int, unsigned int, unsigned long = 0){}
+inline void noTone(int){}
+
+inline void attachInterrupt(int, void (*)(), int){}
+inline void noInterrupts(){}
+inline void interrupts(){}
+
+template <class T, class U> inline T min(T first, U second){ return first < (T) second ? first : (T) second; }
+template <class T, class U> inline T max(T first, U second){ return first > (T) second ? first : (T) second; }
+
+// only what the sketch does with strings: build a number and read it
+struct String{
+  std::string text;
+
+  String &operator+=(char character){ text += character; return *this; }
+  String &operator+=(const char *other){ text += other; return *this; }
+  long toInt() const{ return atol(text.c_str()); }
+};
+
+struct HostSerial{
+  void begin(long){}
+  int available(){ return 0; }
+  int read(){ return -1; }
+  int availableForWrite(){ return 64; }
+
+  template <class T> void print(T){}
+  template <class T> void println(T){}
+  void println(){}
+  size_t write(byte){ return 1; }
+  size_t write(const byte *, size_t size){ return size; }
+};
+
+HostSerial Serial;
+
+#endif
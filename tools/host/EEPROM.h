@@ -0,0 +1,53 @@
+#pragma once
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <string.h>
+
+#include "Arduino.h"
+
+/*
+  The 1 KB EEPROM of the ATmega328P, erased (every byte 0xFF)
+  when the host tool starts. Counts the writes of every
+  address, like the wear the board's EEPROM would get.
+*/
+struct HostEEPROM{
+  byte bytes[1024];
+  unsigned long writes[1024];
+
+  HostEEPROM(){
+    memset(bytes, 0xFF, sizeof(bytes));
+    memset(writes, 0, sizeof(writes));
+  }
+
+  int length(){ return sizeof(bytes); }
+  byte read(int address){ return bytes[address]; }
+
+  void write(int address, byte value){
+    bytes[address] = value;
+    writes[address] += 1;
+  }
+
+  void update(int address, byte value){
+    if (bytes[address] != value) {
+      write(address, value);
+    }
+  }
+
+  template <class T> T &get(int address, T &value){
+    memcpy((void *) &value, bytes + address, sizeof(T));
+    return value;
+  }
+
+  template <class T> const T &put(int address, const T &value){
+    const byte *source = (const byte *) &value;
+    for (size_t i = 0; i < sizeof(T); i++) {
+      update(address + i, source[i]);
+    }
+    return value;
+  }
+};
+
+HostEEPROM EEPROM;
+
+#endif
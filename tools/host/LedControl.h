@@ -0,0 +1,36 @@
+#pragma once
+#ifndef HOST_LED_CONTROL_H
+#define HOST_LED_CONTROL_H
+
+#include "Arduino.h"
+
+/*
+  A single 8x8 matrix: every row is a byte,
+  the leftmost column being the highest bit.
+*/
+struct LedControl{
+  byte rows[8];
+  byte intensity;
+  bool isShutdown;
+
+  LedControl(int, int, int, int): intensity(0), isShutdown(true){
+    clearDisplay(0);
+  }
+
+  void shutdown(int, bool status){ isShutdown = status; }
+  void setIntensity(int, int value){ intensity = (byte) value; }
+  void clearDisplay(int){ memset(rows, 0, sizeof(rows)); }
+  void setRow(int, int row, byte value){ rows[row & 7] = value; }
+
+  void setLed(int, int row, int column, bool state){
+    byte mask = 0x80 >> (column & 7);
+
+    if (state) {
+      rows[row & 7] |= mask;
+    } else {
+      rows[row & 7] &= ~mask;
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef HOST_LIQUID_CRYSTAL_H
+#define HOST_LIQUID_CRYSTAL_H
+
+#include "Arduino.h"
+
+/*
+  A 16x2 HD44780: each line has 40 characters of memory, of which
+  the first 16 are visible; writing past the end of a line
+  continues on the other one, like on the real controller.
+  Custom characters are stored as their codes, 0 - 7.
+*/
+struct LiquidCrystal{
+  char lines[2][40];
+  byte column;
+  byte line;
+  bool isCursorVisible;
+  bool isBlinking;
+
+  LiquidCrystal(int, int, int, int, int, int): column(0), line(0), isCursorVisible(false), isBlinking(false){
+    clear();
+  }
+
+  void begin(int, int){}
+  void createChar(int, byte *){}
+  void createChar(int, const byte *){}
+
+  void clear(){
+    memset(lines, ' ', sizeof(lines));
+    home();
+  }
+
+  void home(){ column = 0; line = 0; }
+  void setCursor(int newColumn, int newLine){ column = (byte) (newColumn % 40); line = (byte) (newLine & 1); }
+  void cursor(){ isCursorVisible = true; }
+  void noCursor(){ isCursorVisible = false; }
+  void blink(){ isBlinking = true; }
+  void noBlink(){ isBlinking = false; }
+
+  size_t write(byte character){
+    lines[line][column] = (char) character;
+    column += 1;
+
+    if (column == 40) {
+      column = 0;
+      line ^= 1;
+    }
+    return 1;
+  }
+
+  size_t write(int character){ return write((byte) character); }
+  size_t write(const char *text){ return print(text); }
+
+  size_t print(const char *text){
+    size_t size = 0;
+    while (text[size] != 0) {
+      write((byte) text[size]);
+      size += 1;
+    }
+    return size;
+  }
+
+  size_t print(char character){ return write((byte) character); }
+  size_t print(long value){ return printNumber("%ld", value); }
+  size_t print(int value){ return print((long) value); }
+  size_t print(unsigned long value){ return printNumber("%lu", value); }
+  size_t print(unsigned int value){ return print((unsigned long) value); }
+  size_t print(byte value){ return print((unsigned long) value); }
+
+  template <class T> size_t printNumber(const char *format, T value){
+    char text[24];
+    snprintf(text, sizeof(text), format, value);
+    return print(text);
+  }
+};
+
+#endif
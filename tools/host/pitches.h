@@ -0,0 +1,27 @@
+#pragma once
+#ifndef HOST_PITCHES_H
+#define HOST_PITCHES_H
+
+/*
+  The notes of the standard pitches.h of the Arduino
+  examples that the melodies use; the host only needs
+  them to compile, the frequencies are not played.
+*/
+#define REST 0
+#define NOTE_C2 65
+#define NOTE_D2 73
+#define NOTE_E2 82
+#define NOTE_G2 98
+#define NOTE_A2 110
+#define NOTE_D4 294
+#define NOTE_DS4 311
+#define NOTE_F4 349
+#define NOTE_G4 392
+#define NOTE_GS4 415
+#define NOTE_A4 440
+#define NOTE_AS4 466
+#define NOTE_G5 784
+#define NOTE_B5 988
+#define NOTE_D6 1175
+
+#endif